@@ -0,0 +1,257 @@
+#include "AlignedChunkPool.h"
+#include "MemoryPressure.h"
+#include <algorithm>
+#include <stdexcept>
+#include <sys/mman.h>
+
+// Lives in the first line of every chunk
+struct ChunkHeader {
+    AlignedChunkPool* owner;
+    uint32_t sizeClass;             // Index into the owner's classes
+    uint32_t blockSize;
+    void* freeList;                 // Blocks freed back into this chunk
+    char* unused;                   // Next block never handed out
+    char* end;                      // One past the last block
+    size_t freeBlocks;              // Free-listed plus never handed out
+    ChunkHeader* prev;              // In the class's list of chunks with free blocks
+    ChunkHeader* next;
+};
+
+namespace {
+
+const int CHUNK_SHIFT = 21;
+const size_t HEADER_BYTES = 64;
+const int ADDRESS_BITS = 48;
+
+static_assert(AlignedChunkPool::CHUNK_BYTES == size_t(1) << CHUNK_SHIFT, "chunk size and shift disagree");
+static_assert(sizeof(ChunkHeader) <= HEADER_BYTES, "chunk header outgrew its line");
+
+// One bit per 2 MB of the 48-bit address space, set while a chunk lives
+// there: 16 MB of address space, mapped MAP_NORESERVE. Untouched words read
+// as zero from the shared zero page, so only words covering live chunks
+// ever become resident (4 KB per 64 GB of chunk addresses).
+uint64_t* chunkBits() {
+    static uint64_t* bits = [] {
+        size_t bytes = (size_t(1) << (ADDRESS_BITS - CHUNK_SHIFT)) / 8;
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return mapped == MAP_FAILED ? nullptr : static_cast<uint64_t*>(mapped);
+    }();
+    return bits;
+}
+
+inline ChunkHeader* headerOf(const void* ptr) {
+    return reinterpret_cast<ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(AlignedChunkPool::CHUNK_BYTES - 1));
+}
+
+inline bool isChunk(const void* ptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    uint64_t* bits = chunkBits();
+    if ((address >> ADDRESS_BITS) != 0 || !bits) {
+        return false;
+    }
+    size_t index = address >> CHUNK_SHIFT;
+    return (__atomic_load_n(&bits[index / 64], __ATOMIC_ACQUIRE) >> (index % 64)) & 1;
+}
+
+// Published after the header is written, withdrawn before the unmap
+void markChunk(ChunkHeader* header, bool live) {
+    size_t index = reinterpret_cast<uintptr_t>(header) >> CHUNK_SHIFT;
+    uint64_t mask = uint64_t(1) << (index % 64);
+    if (live) {
+        __atomic_fetch_or(&chunkBits()[index / 64], mask, __ATOMIC_RELEASE);
+    } else {
+        __atomic_fetch_and(&chunkBits()[index / 64], ~mask, __ATOMIC_RELEASE);
+    }
+}
+
+void listPush(ChunkHeader*& head, ChunkHeader* chunk) {
+    chunk->prev = nullptr;
+    chunk->next = head;
+    if (head) {
+        head->prev = chunk;
+    }
+    head = chunk;
+}
+
+void listRemove(ChunkHeader*& head, ChunkHeader* chunk) {
+    if (chunk->prev) {
+        chunk->prev->next = chunk->next;
+    } else {
+        head = chunk->next;
+    }
+    if (chunk->next) {
+        chunk->next->prev = chunk->prev;
+    }
+    chunk->prev = chunk->next = nullptr;
+}
+
+} // namespace
+
+struct AlignedChunkPool::SizeClass {
+    std::mutex mutex;               // Used when the pool is thread-safe
+    size_t blockSize;
+    size_t blocksPerChunk;
+    size_t usedBlocks = 0;
+    ChunkHeader* partial = nullptr; // Chunks with a free block
+    std::vector<ChunkHeader*> chunks;
+};
+
+AlignedChunkPool::AlignedChunkPool(const std::vector<size_t>& blockSizes, bool threadSafe)
+    : threadSafe(threadSafe) {
+    if (blockSizes.empty()) {
+        throw std::invalid_argument("At least one block size is required");
+    }
+    if (!chunkBits()) {
+        throw std::bad_alloc();
+    }
+    std::vector<size_t> sizes;
+    for (size_t size : blockSizes) {
+        size_t aligned = (std::max<size_t>(size, sizeof(void*)) + 15) & ~size_t(15);
+        if (aligned > CHUNK_BYTES - HEADER_BYTES) {
+            throw std::invalid_argument("Block size does not fit in a chunk");
+        }
+        sizes.push_back(aligned);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    for (size_t size : sizes) {
+        std::unique_ptr<SizeClass> sizeClass(new SizeClass());
+        sizeClass->blockSize = size;
+        sizeClass->blocksPerChunk = (CHUNK_BYTES - HEADER_BYTES) / size;
+        classes.push_back(std::move(sizeClass));
+    }
+}
+
+AlignedChunkPool::~AlignedChunkPool() {
+    for (const auto& sizeClass : classes) {
+        for (ChunkHeader* chunk : sizeClass->chunks) {
+            markChunk(chunk, false);
+            munmap(chunk, CHUNK_BYTES);
+            MemoryPressure::release(CHUNK_BYTES, true);
+        }
+    }
+}
+
+// Class lock held. Maps twice the chunk size and trims it to alignment.
+ChunkHeader* AlignedChunkPool::addChunk(SizeClass& sizeClass, size_t index) {
+    if (!MemoryPressure::reserve(CHUNK_BYTES, true)) {
+        return nullptr;
+    }
+    void* mapped = mmap(nullptr, 2 * CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        MemoryPressure::release(CHUNK_BYTES, true);
+        return nullptr;
+    }
+    uintptr_t raw = reinterpret_cast<uintptr_t>(mapped);
+    uintptr_t start = (raw + CHUNK_BYTES - 1) & ~(CHUNK_BYTES - 1);
+    if (start > raw) {
+        munmap(mapped, start - raw);
+    }
+    munmap(reinterpret_cast<void*>(start + CHUNK_BYTES), raw + CHUNK_BYTES - start);
+
+    // Blocks are carved on demand, so only the header page is touched now
+    ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(start);
+    chunk->owner = this;
+    chunk->sizeClass = static_cast<uint32_t>(index);
+    chunk->blockSize = static_cast<uint32_t>(sizeClass.blockSize);
+    chunk->freeList = nullptr;
+    chunk->unused = reinterpret_cast<char*>(start) + HEADER_BYTES;
+    chunk->end = chunk->unused + sizeClass.blocksPerChunk * sizeClass.blockSize;
+    chunk->freeBlocks = sizeClass.blocksPerChunk;
+    listPush(sizeClass.partial, chunk);
+    sizeClass.chunks.push_back(chunk);
+    markChunk(chunk, true);
+    return chunk;
+}
+
+void* AlignedChunkPool::allocate(size_t size) {
+    size_t index = 0;
+    while (index < classes.size() && classes[index]->blockSize < size) {
+        ++index;
+    }
+    if (index == classes.size()) {
+        return nullptr;
+    }
+    SizeClass& sizeClass = *classes[index];
+    std::unique_lock<std::mutex> lock(sizeClass.mutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    ChunkHeader* chunk = sizeClass.partial;
+    if (!chunk && !(chunk = addChunk(sizeClass, index))) {
+        return nullptr;
+    }
+    void* block = chunk->freeList;
+    if (block) {
+        chunk->freeList = *static_cast<void**>(block);
+    } else {
+        block = chunk->unused;
+        chunk->unused += sizeClass.blockSize;
+    }
+    if (--chunk->freeBlocks == 0) {
+        listRemove(sizeClass.partial, chunk);
+    }
+    ++sizeClass.usedBlocks;
+    return block;
+}
+
+void AlignedChunkPool::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    ChunkHeader* chunk = headerOf(ptr);
+
+    #ifdef MEMPOOL_SAFE_MODE
+    if (!owns(ptr)) {
+        throw std::invalid_argument("Pointer not from this pool");
+    }
+    if ((static_cast<char*>(ptr) - reinterpret_cast<char*>(chunk) - HEADER_BYTES) % chunk->blockSize != 0) {
+        throw std::invalid_argument("Pointer not at a block boundary");
+    }
+    #endif
+
+    SizeClass& sizeClass = *classes[chunk->sizeClass];
+    std::unique_lock<std::mutex> lock(sizeClass.mutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    *static_cast<void**>(ptr) = chunk->freeList;
+    chunk->freeList = ptr;
+    if (chunk->freeBlocks++ == 0) {
+        listPush(sizeClass.partial, chunk);
+    }
+    --sizeClass.usedBlocks;
+}
+
+bool AlignedChunkPool::owns(const void* ptr) const {
+    if (!isChunk(ptr)) {
+        return false;
+    }
+    const ChunkHeader* chunk = headerOf(ptr);
+    const char* address = static_cast<const char*>(ptr);
+    return chunk->owner == this && address >= reinterpret_cast<const char*>(chunk) + HEADER_BYTES
+        && address < chunk->end;
+}
+
+AlignedChunkPool* AlignedChunkPool::ownerOf(const void* ptr) {
+    return isChunk(ptr) ? headerOf(ptr)->owner : nullptr;
+}
+
+size_t AlignedChunkPool::getBlockSize(const void* ptr) const {
+    return headerOf(ptr)->blockSize;
+}
+
+AlignedChunkStats AlignedChunkPool::getStats() {
+    AlignedChunkStats stats = { 0, 0, 0 };
+    for (const auto& sizeClass : classes) {
+        std::unique_lock<std::mutex> lock(sizeClass->mutex, std::defer_lock);
+        if (threadSafe) {
+            lock.lock();
+        }
+        stats.chunks += sizeClass->chunks.size();
+        stats.usedBlocks += sizeClass->usedBlocks;
+        stats.freeBlocks += sizeClass->chunks.size() * sizeClass->blocksPerChunk - sizeClass->usedBlocks;
+    }
+    return stats;
+}
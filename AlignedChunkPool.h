@@ -0,0 +1,75 @@
+#ifndef ALIGNED_CHUNK_POOL_H
+#define ALIGNED_CHUNK_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct ChunkHeader;
+
+struct AlignedChunkStats {
+    size_t chunks;                  // 2 MB chunks mapped
+    size_t usedBlocks;              // Across all size classes
+    size_t freeBlocks;              // Carved and free, or never carved yet
+};
+
+// Size-class pools whose blocks live in 2 MB-aligned chunks.
+//
+// Each chunk starts with a header naming the pool and size class that own
+// it, so the owner of any block is its address masked down to the chunk:
+// deallocate(ptr) needs no size and blocks carry no header of their own.
+// With many pools, ownerOf(ptr) finds the right one in a mask and a load
+// instead of a range check per pool. Chunks are carved lazily, so a new
+// chunk only becomes resident as its blocks are handed out.
+//
+//   AlignedChunkPool pools({ 32, 64, 256, 1024 }, true);
+//   void* p = pools.allocate(200);          // from the 256-byte class
+//   AlignedChunkPool::ownerOf(p)->deallocate(p);
+class AlignedChunkPool {
+public:
+    static const size_t CHUNK_BYTES = size_t(1) << 21;
+
+    // One size class per block size (rounded up to 16 bytes). Throws
+    // std::invalid_argument for an empty list or a block that does not
+    // fit in a chunk beside the header.
+    explicit AlignedChunkPool(const std::vector<size_t>& blockSizes, bool threadSafe = false);
+
+    // Unmaps every chunk; blocks still held become invalid
+    ~AlignedChunkPool();
+
+    AlignedChunkPool(const AlignedChunkPool&) = delete;
+    AlignedChunkPool& operator=(const AlignedChunkPool&) = delete;
+
+    // A block from the smallest class that fits size; nullptr if size is
+    // above the largest class or no chunk can be mapped
+    void* allocate(size_t size);
+
+    // Unsized: the size class comes from the chunk header. In
+    // MEMPOOL_SAFE_MODE, pointers this pool does not own throw
+    // std::invalid_argument.
+    void deallocate(void* ptr);
+
+    // Safe for any pointer: chunks are recorded in a process-wide bitmap
+    // before the header is trusted
+    bool owns(const void* ptr) const;
+
+    // The pool owning ptr, or nullptr if no AlignedChunkPool does
+    static AlignedChunkPool* ownerOf(const void* ptr);
+
+    // Block size of ptr's class; ptr must be owned by this pool
+    size_t getBlockSize(const void* ptr) const;
+
+    AlignedChunkStats getStats();
+
+private:
+    struct SizeClass;
+
+    bool threadSafe;
+    std::vector<std::unique_ptr<SizeClass>> classes;    // Ascending block size
+
+    ChunkHeader* addChunk(SizeClass& sizeClass, size_t index);
+};
+
+#endif // ALIGNED_CHUNK_POOL_H
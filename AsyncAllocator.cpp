@@ -0,0 +1,136 @@
+#include "AsyncAllocator.h"
+#include "MemoryPool.h"
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+AsyncAllocator::AsyncAllocator(MemoryPool& pool)
+    : pool(pool)
+    , eventFd(-1)
+    , waiting(false) {
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0) {
+        throw std::system_error(errno, std::generic_category(), "eventfd failed");
+    }
+    AsyncAllocator* expected = nullptr;
+    if (!pool.asyncAllocator.compare_exchange_strong(expected, this)) {
+        close(eventFd);
+        throw std::invalid_argument("Pool already has an AsyncAllocator");
+    }
+}
+
+AsyncAllocator::~AsyncAllocator() {
+    // Under the pool lock, so no free is still serving us afterwards
+    {
+        std::unique_lock<std::mutex> lock(pool.poolMutex, std::defer_lock);
+        if (pool.threadSafe) {
+            lock.lock();
+        }
+        pool.asyncAllocator.store(nullptr, std::memory_order_release);
+    }
+    std::vector<std::pair<Callback, void*>> undelivered;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.clear();
+        updateWaiting();
+        undelivered.swap(completed);
+    }
+    for (const auto& request : undelivered) {
+        pool.deallocate(request.second);
+    }
+    close(eventFd);
+}
+
+void* AsyncAllocator::allocate(Callback done) {
+    void* block = pool.allocate();
+    if (block) {
+        return block;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.push_back(std::move(done));
+        updateWaiting();
+    }
+
+    // A free that came before we were counted left its block on the free
+    // list; frees from now on serve the queue themselves
+    std::unique_lock<std::mutex> lock(pool.poolMutex, std::defer_lock);
+    if (pool.threadSafe) {
+        lock.lock();
+    }
+    serve();
+    return nullptr;
+}
+
+size_t AsyncAllocator::dispatch() {
+    // Drain the counter first: a request completed after the swap below
+    // signals again
+    uint64_t signals;
+    ssize_t received = read(eventFd, &signals, sizeof(signals));
+    (void)received;
+
+    std::vector<std::pair<Callback, void*>> ready;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        ready.swap(completed);
+    }
+    for (const auto& request : ready) {
+        request.first(request.second);
+    }
+    return ready.size();
+}
+
+size_t AsyncAllocator::getPendingCount() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return pending.size();
+}
+
+bool AsyncAllocator::serve() {
+    bool signal;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (pending.empty()) {
+            return false;
+        }
+        void* block = pool.allocateInternal();
+        if (!block) {
+            return false;
+        }
+        signal = completed.empty();
+        completed.emplace_back(std::move(pending.front()), block);
+        pending.pop_front();
+        updateWaiting();
+    }
+    // Only the first completion needs to wake the loop
+    if (signal) {
+        uint64_t one = 1;
+        ssize_t written = write(eventFd, &one, sizeof(one));
+        (void)written;
+    }
+    return true;
+}
+
+void AsyncAllocator::requeueCompleted() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (auto it = completed.rbegin(); it != completed.rend(); ++it) {
+        pending.push_front(std::move(it->first));
+    }
+    completed.clear();
+    updateWaiting();
+}
+
+void AsyncAllocator::updateWaiting() {
+    bool hasPending = !pending.empty();
+    if (hasPending == waiting) {
+        return;
+    }
+    waiting = hasPending;
+    if (waiting) {
+        pool.addWaiter();
+    } else {
+        pool.removeWaiter();
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef ASYNC_ALLOCATOR_H
+#define ASYNC_ALLOCATOR_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+class MemoryPool;
+
+// Non-blocking allocation for event loops.
+//
+// allocate() returns a block at once when the pool has one. Otherwise it
+// queues the request and returns nullptr. It never blocks. While requests
+// are queued, the allocator counts as one of the pool's allocateWait()
+// sleepers, so the next deallocate() reserves a block for the oldest
+// request under the pool lock. That block is never seen by other threads.
+// The eventfd then becomes readable, and dispatch() on the loop thread
+// runs each completed request's callback with its block.
+//
+//   AsyncAllocator async(pool);
+//   epoll_ctl(epfd, EPOLL_CTL_ADD, async.getEventFd(), &event);
+//   if (void* p = async.allocate([](void* p) { resume(p); })) { ... }
+//   ...                                     // EPOLLIN on the eventfd:
+//   async.dispatch();                       // runs resume(p)
+//
+// One AsyncAllocator per pool. As with allocateWait(), blocks freed into
+// per-thread or per-CPU caches complete nothing until they are flushed.
+class AsyncAllocator {
+public:
+    typedef std::function<void(void* block)> Callback;
+
+    // Throws std::invalid_argument if the pool already has one, and
+    // std::system_error if the eventfd cannot be created
+    explicit AsyncAllocator(MemoryPool& pool);
+
+    // Drops queued requests and returns undispatched blocks to the pool.
+    // A lock-free pool must see no frees meanwhile.
+    ~AsyncAllocator();
+
+    AsyncAllocator(const AsyncAllocator&) = delete;
+    AsyncAllocator& operator=(const AsyncAllocator&) = delete;
+
+    // A block if one is free now; otherwise nullptr, and done(block) runs
+    // from dispatch() once a freed block has been reserved for it.
+    // Requests are completed in FIFO order.
+    void* allocate(Callback done);
+
+    // Non-blocking eventfd, readable while completed requests await dispatch()
+    int getEventFd() const { return eventFd; }
+
+    // Runs the callbacks of completed requests on the calling thread and
+    // returns how many ran. Callbacks may allocate and free.
+    size_t dispatch();
+
+    size_t getPendingCount();               // Queued, no block yet
+
+private:
+    friend class MemoryPool;
+
+    MemoryPool& pool;
+    int eventFd;
+    std::mutex queueMutex;                  // Guards both queues
+    std::deque<Callback> pending;
+    std::vector<std::pair<Callback, void*>> completed;
+    bool waiting;                           // Counted in the pool's waiters
+
+    // Pool lock held: reserve a block for the oldest pending request.
+    // False if none is pending or the pool has no block for it.
+    bool serve();
+
+    // Pool lock held, after reset(): completed blocks are free again, so
+    // their requests go back to the front of the queue
+    void requeueCompleted();
+
+    // queueMutex held: count as a waiter exactly while requests are pending
+    void updateWaiting();
+};
+
+#endif // ASYNC_ALLOCATOR_H
@@ -0,0 +1,347 @@
+#ifndef BASIC_POOL_H
+#define BASIC_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Header-only fixed-size pool whose features are chosen at compile time.
+//
+// BasicPool<Config> takes its behaviour from the policy types named in
+// Config. Empty policies are empty base classes and their hooks are inline
+// no-ops, so with the default config allocate() compiles down to the same
+// pop-from-free-list MemoryPool does, inlined into the caller. Use it where
+// the fast path matters most; use MemoryPool for the runtime diagnostics
+// (quarantine, leak sites, profiling, registry, trim).
+//
+//   struct SharedConfig : DefaultPoolConfig {
+//       typedef SpinLock LockPolicy;
+//       typedef ChunkedGrowth GrowthPolicy;
+//   };
+//   BasicPool<SharedConfig> pool(64, 1024);
+
+// ---- Lock policies ----
+
+struct NoLock {
+    void lock() {}
+    void unlock() {}
+};
+
+struct MutexLock {
+    std::mutex mutex;
+    void lock() { mutex.lock(); }
+    void unlock() { mutex.unlock(); }
+};
+
+struct SpinLock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    void lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+    }
+    void unlock() { flag.clear(std::memory_order_release); }
+};
+
+// ---- Growth policies: blocks to add when the pool runs dry (0 = none) ----
+
+struct FixedCapacity {
+    static size_t growBlocks(size_t /*totalBlocks*/, size_t /*initialBlocks*/) { return 0; }
+};
+
+// Adds chunks of the initial size. The pool stays one contiguous range only
+// with ReservedBacking.
+struct ChunkedGrowth {
+    static size_t growBlocks(size_t /*totalBlocks*/, size_t initialBlocks) { return initialBlocks; }
+};
+
+// ---- Stats policies ----
+
+struct NoStats {
+    void onAllocate(size_t /*usedBlocks*/) {}
+    void onDeallocate() {}
+    void onExhausted() {}
+};
+
+struct CountingStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t failures = 0;            // allocate() returned nullptr
+    size_t peakUsed = 0;
+    void onAllocate(size_t usedBlocks) {
+        ++allocations;
+        if (usedBlocks > peakUsed) {
+            peakUsed = usedBlocks;
+        }
+    }
+    void onDeallocate() { ++deallocations; }
+    void onExhausted() { ++failures; }
+};
+
+// ---- Safety policies: validate pointers passed to deallocate() ----
+
+struct Unchecked {
+    template <class Chunks>
+    static void checkOwned(const void* /*ptr*/, const Chunks& /*chunks*/, size_t /*blockSize*/) {}
+};
+
+// Same contract as MEMPOOL_SAFE_MODE: foreign or misaligned pointers throw
+struct BoundsChecked {
+    template <class Chunks>
+    static void checkOwned(const void* ptr, const Chunks& chunks, size_t blockSize) {
+        const char* address = static_cast<const char*>(ptr);
+        for (const auto& chunk : chunks) {
+            const char* start = static_cast<const char*>(chunk.first);
+            if (address >= start && address < start + chunk.second * blockSize) {
+                if ((address - start) % blockSize != 0) {
+                    throw std::invalid_argument("Pointer not at a block boundary");
+                }
+                return;
+            }
+        }
+        throw std::invalid_argument("Pointer not from this pool");
+    }
+};
+
+// ---- Backing-memory policies ----
+
+struct MallocBacking {
+    static void* acquire(size_t bytes) {
+        void* memory = std::malloc(bytes);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    static void release(void* memory, size_t /*bytes*/) { std::free(memory); }
+};
+
+struct MmapBacking {
+    static void* acquire(size_t bytes) {
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+    static void release(void* memory, size_t bytes) { munmap(memory, bytes); }
+};
+
+// Reserves ReserveBytes of address space on first use (PROT_NONE,
+// MAP_NORESERVE, so it costs neither memory nor commit charge) and commits
+// each chunk right after the previous one. Chunks are therefore one
+// contiguous range: BasicPool keeps a single chunk entry, so owns() and
+// BoundsChecked are one range test however often the pool grew, and RSS
+// follows the blocks actually added. Growth past the reservation fails.
+template <size_t ReserveBytes>
+struct ReservedBacking {
+    static const bool contiguous = true;
+
+    char* rangeStart = nullptr;
+    size_t rangeUsed = 0;           // Bytes handed out as chunks
+    size_t rangeCommitted = 0;      // Bytes made readable and writable
+
+    ReservedBacking() = default;
+    ReservedBacking(const ReservedBacking&) = delete;
+    ReservedBacking& operator=(const ReservedBacking&) = delete;
+    ~ReservedBacking() {
+        if (rangeStart) {
+            munmap(rangeStart, ReserveBytes);
+        }
+    }
+
+    void* acquire(size_t bytes) {
+        if (!rangeStart) {
+            void* range = mmap(nullptr, ReserveBytes, PROT_NONE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (range == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            rangeStart = static_cast<char*>(range);
+        }
+        if (bytes > ReserveBytes - rangeUsed) {
+            throw std::bad_alloc();
+        }
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t end = (rangeUsed + bytes + page - 1) & ~(page - 1);
+        if (end > rangeCommitted) {
+            if (mprotect(rangeStart + rangeCommitted, end - rangeCommitted, PROT_READ | PROT_WRITE) != 0) {
+                throw std::bad_alloc();
+            }
+            rangeCommitted = end;
+        }
+        void* memory = rangeStart + rangeUsed;
+        rangeUsed += bytes;
+        return memory;
+    }
+
+    // The whole range is unmapped with the backing
+    void release(void* /*memory*/, size_t /*bytes*/) {}
+};
+
+// Whether a backing hands out each chunk right after the previous one
+template <class Backing, class = void>
+struct IsContiguousBacking : std::false_type {};
+
+template <class Backing>
+struct IsContiguousBacking<Backing, typename std::enable_if<Backing::contiguous>::type> : std::true_type {};
+
+// The plain pool: single-threaded, fixed size, no stats, no checks
+struct DefaultPoolConfig {
+    typedef NoLock LockPolicy;
+    typedef FixedCapacity GrowthPolicy;
+    typedef NoStats StatsPolicy;
+    typedef Unchecked SafetyPolicy;
+    typedef MallocBacking BackingPolicy;
+    static constexpr size_t alignment = alignof(std::max_align_t);
+};
+
+// Backing policies are bases too, so they may keep state (ReservedBacking);
+// the stateless ones are empty and cost nothing
+template <class Config = DefaultPoolConfig>
+class BasicPool : private Config::LockPolicy, public Config::StatsPolicy, private Config::BackingPolicy {
+private:
+    typedef typename Config::LockPolicy Lock;
+    typedef typename Config::GrowthPolicy Growth;
+    typedef typename Config::StatsPolicy Stats;
+    typedef typename Config::SafetyPolicy Safety;
+    typedef typename Config::BackingPolicy Backing;
+
+    static_assert((Config::alignment & (Config::alignment - 1)) == 0, "alignment must be a power of two");
+
+    struct Block {
+        Block* next;
+    };
+
+    Block* freeList;                // Head of free list
+    size_t blockSize;               // Size of each block (aligned)
+    size_t initialBlocks;           // Blocks in the first chunk
+    size_t totalBlocks;             // Blocks across all chunks
+    size_t freeBlockCount;
+    std::vector<std::pair<void*, size_t>> chunks;   // (memory, blocks); one with contiguous backings
+
+    static constexpr size_t alignSize(size_t size) {
+        return (size + Config::alignment - 1) & ~(Config::alignment - 1);
+    }
+
+    // Carve a new chunk and push its blocks, in address order, on the free list
+    void addChunk(size_t numBlocks) {
+        char* memory = static_cast<char*>(Backing::acquire(blockSize * numBlocks));
+        if (IsContiguousBacking<Backing>::value && !chunks.empty()) {
+            chunks.back().second += numBlocks;
+        } else {
+            chunks.push_back(std::make_pair(static_cast<void*>(memory), numBlocks));
+        }
+        for (size_t i = 0; i + 1 < numBlocks; ++i) {
+            reinterpret_cast<Block*>(memory + i * blockSize)->next = reinterpret_cast<Block*>(memory + (i + 1) * blockSize);
+        }
+        reinterpret_cast<Block*>(memory + (numBlocks - 1) * blockSize)->next = freeList;
+        freeList = reinterpret_cast<Block*>(memory);
+        totalBlocks += numBlocks;
+        freeBlockCount += numBlocks;
+    }
+
+    // Out of line so the inlined fast path stays small. A chunk the backing
+    // cannot provide fails the growth like exhaustion.
+    __attribute__((noinline)) bool grow() {
+        size_t blocks = Growth::growBlocks(totalBlocks, initialBlocks);
+        if (blocks == 0) {
+            return false;
+        }
+        try {
+            addChunk(blocks);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+public:
+    BasicPool(size_t blockSize, size_t numBlocks)
+        : freeList(nullptr)
+        , blockSize(alignSize(blockSize < sizeof(Block) ? sizeof(Block) : blockSize))
+        , initialBlocks(numBlocks)
+        , totalBlocks(0)
+        , freeBlockCount(0) {
+        if (numBlocks == 0) {
+            throw std::invalid_argument("Number of blocks must be greater than 0");
+        }
+        addChunk(numBlocks);
+    }
+
+    ~BasicPool() {
+        for (const auto& chunk : chunks) {
+            Backing::release(chunk.first, blockSize * chunk.second);
+        }
+    }
+
+    BasicPool(const BasicPool&) = delete;
+    BasicPool& operator=(const BasicPool&) = delete;
+
+    inline void* allocate() {
+        Lock::lock();
+        if (__builtin_expect(!freeList, 0) && !grow()) {
+            Stats::onExhausted();
+            Lock::unlock();
+            return nullptr;
+        }
+        Block* block = freeList;
+        freeList = block->next;
+        --freeBlockCount;
+        Stats::onAllocate(totalBlocks - freeBlockCount);
+        Lock::unlock();
+        return block;
+    }
+
+    inline void deallocate(void* ptr) {
+        if (!ptr) {
+            return;
+        }
+        Lock::lock();
+        try {
+            Safety::checkOwned(ptr, chunks, blockSize);
+        } catch (...) {
+            Lock::unlock();
+            throw;
+        }
+        Block* block = static_cast<Block*>(ptr);
+        block->next = freeList;
+        freeList = block;
+        ++freeBlockCount;
+        Stats::onDeallocate();
+        Lock::unlock();
+    }
+
+    // Query functions (unlocked reads, like MemoryPool's)
+    inline bool isExhausted() const { return freeBlockCount == 0; }
+    inline size_t getUsedBlocks() const { return totalBlocks - freeBlockCount; }
+    inline size_t getFreeBlocks() const { return freeBlockCount; }
+    inline size_t getBlockSize() const { return blockSize; }
+    inline size_t getTotalBlocks() const { return totalBlocks; }
+    inline size_t getChunkCount() const { return chunks.size(); }
+
+    // Whether ptr lies inside one of the pool's chunks; a single range test
+    // with a contiguous backing
+    bool owns(const void* ptr) const {
+        const char* address = static_cast<const char*>(ptr);
+        for (const auto& chunk : chunks) {
+            const char* start = static_cast<const char*>(chunk.first);
+            if (address >= start && address < start + chunk.second * blockSize) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // BASIC_POOL_H
@@ -1,9 +1,28 @@
 #include "MemoryPool.h"
+#include "AlignedChunkPool.h"
+#include "AsyncAllocator.h"
+#include "BasicPool.h"
+#include "BitmapPool.h"
+#include "DelegatedAllocator.h"
+#include "HeapProfiler.h"
+#include "PageMap.h"
+#include "EpochReclaimer.h"
+#include "SmallObjectAllocator.h"
+#include "SpscRing.h"
+#include "TenantPool.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <pthread.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 
 using namespace std::chrono;
 
@@ -34,6 +53,26 @@ void printResult(const std::string& name, double mallocMs, double poolMs, size_t
               << color << std::setw(12) << speedup << "x" << RESET << "\n";
 }
 
+// Feature benchmarks compare a plain pool against one with an option enabled
+void printOverhead(const std::string& name, double baseMs, double featureMs) {
+    double ratio = featureMs / baseMs;
+    std::string color = (ratio <= 1.5) ? GREEN : YELLOW;
+    
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(2) << baseMs
+              << std::setw(12) << featureMs
+              << color << std::setw(12) << ratio << "x" << RESET << "\n";
+}
+
+void printOverheadHeader() {
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Feature Overhead"
+              << std::right << std::setw(12) << "Plain(ms)"
+              << std::setw(12) << "Feature(ms)"
+              << std::setw(12) << "Cost\n";
+    std::cout << std::string(76, '-') << "\n";
+}
+
 // Benchmark: Ultra-tight single allocation loop
 void benchmarkUltraTight() {
     const size_t ITERATIONS = 10000000;  // 10 million
@@ -260,6 +299,1296 @@ void benchmarkWithWrites() {
     printResult("With Data Writes (64B, 5M ops)", mallocTime, poolTime, ITERATIONS * 2);
 }
 
+// Churn a pool the way a service would: a window of live blocks, oldest freed first
+double churnPool(MemoryPool& pool, size_t iterations, size_t window) {
+    std::vector<void*> live(window, nullptr);
+    
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t slot = i % window;
+        pool.deallocate(live[slot]);
+        live[slot] = pool.allocate();
+        use_pointer(live[slot]);
+    }
+    auto end = high_resolution_clock::now();
+    
+    for (void* ptr : live) {
+        pool.deallocate(ptr);
+    }
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: Quarantine cost (poison + ring push per free). Only a 64-byte
+// prefix is poisoned by default, so large blocks cost about as much as small.
+void benchmarkQuarantine() {
+    const size_t ITERATIONS = 5000000;
+    const size_t WINDOW = 256;
+    
+    for (size_t blockSize : { 64, 1024 }) {
+        MemoryPool plain(blockSize, 4096);
+        double plainTime = churnPool(plain, ITERATIONS, WINDOW);
+        
+        PoolOptions options;
+        options.quarantineBlocks = 1024;
+        MemoryPool quarantined(blockSize, 4096, options);
+        double quarantineTime = churnPool(quarantined, ITERATIONS, WINDOW);
+        printOverhead("Quarantine (" + std::to_string(blockSize) + "B, 1024 deep)", plainTime, quarantineTime);
+        
+        if (blockSize > 64) {
+            options.quarantinePoisonAll = true;
+            MemoryPool poisoned(blockSize, 4096, options);
+            double poisonedTime = churnPool(poisoned, ITERATIONS, WINDOW);
+            printOverhead("Quarantine (" + std::to_string(blockSize) + "B, whole block)", plainTime, poisonedTime);
+        }
+    }
+}
+
+// Benchmark: Sampling profiler cost (one relaxed load when off, countdown when on)
+void benchmarkHeapProfiler() {
+    const size_t ITERATIONS = 5000000;
+    const size_t BLOCK_SIZE = 64;
+    const size_t WINDOW = 256;
+    
+    MemoryPool pool(BLOCK_SIZE, 4096);
+    double plainTime = churnPool(pool, ITERATIONS, WINDOW);
+    
+    HeapProfiler::start(512 * 1024);
+    double profiledTime = churnPool(pool, ITERATIONS, WINDOW);
+    HeapProfiler::stop();
+    
+    printOverhead("Heap Profiler (64B, 512KB interval)", plainTime, profiledTime);
+}
+
+// Drain a pool, zeroing every block one of two ways
+double drainZeroed(MemoryPool& pool, bool useAllocateZeroed) {
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < pool.getTotalBlocks(); ++i) {
+        void* p;
+        if (useAllocateZeroed) {
+            p = pool.allocateZeroed();
+        } else {
+            p = pool.allocate();
+            std::memset(p, 0, pool.getBlockSize());
+        }
+        use_pointer(p);
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: allocate + memset against allocateZeroed with known-zero tracking
+void benchmarkZeroed() {
+    const size_t ROUNDS = 20;
+    const size_t BLOCK_SIZE = 256;
+    const size_t NUM_BLOCKS = 65536;    // 16 MB: reset uses streaming stores
+    
+    PoolOptions options;
+    options.trackZeroed = true;
+    options.zeroOnReset = true;
+    
+    // Fresh pools: every block is known-zero, allocateZeroed skips the memset
+    double memsetTime = 0, zeroedTime = 0;
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        MemoryPool plain(BLOCK_SIZE, NUM_BLOCKS);
+        memsetTime += drainZeroed(plain, false);
+        plain.reset();
+        MemoryPool zeroed(BLOCK_SIZE, NUM_BLOCKS, options);
+        zeroedTime += drainZeroed(zeroed, true);
+        zeroed.reset();
+    }
+    printOverhead("Zeroed alloc, fresh pool (256B)", memsetTime, zeroedTime);
+    
+    // Steady state: each round drains and resets, so the bulk zeroing is paid
+    // in reset(). Streaming stores leave the cache alone, so the next drain
+    // reads its links from memory; the win is for whatever else was cached.
+    MemoryPool plain(BLOCK_SIZE, NUM_BLOCKS);
+    MemoryPool zeroed(BLOCK_SIZE, NUM_BLOCKS, options);
+    memsetTime = 0;
+    zeroedTime = 0;
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        auto start = high_resolution_clock::now();
+        drainZeroed(plain, false);
+        plain.reset();
+        auto end = high_resolution_clock::now();
+        memsetTime += duration_cast<microseconds>(end - start).count() / 1000.0;
+        
+        start = high_resolution_clock::now();
+        drainZeroed(zeroed, true);
+        zeroed.reset();
+        end = high_resolution_clock::now();
+        zeroedTime += duration_cast<microseconds>(end - start).count() / 1000.0;
+    }
+    printOverhead("Zeroed alloc + zeroing reset (16MB)", memsetTime, zeroedTime);
+}
+
+// The original constructor loop: each link is read back to find the next block
+__attribute__((noinline)) void linkChained(char* memory, size_t blockSize, size_t numBlocks) {
+    void** current = reinterpret_cast<void**>(memory);
+    for (size_t i = 0; i < numBlocks - 1; ++i) {
+        *current = reinterpret_cast<char*>(current) + blockSize;
+        current = static_cast<void**>(*current);
+    }
+    *current = nullptr;
+}
+
+// Benchmark: Free-list initialization across pool sizes. Both columns link
+// resident memory, so page faults do not hide the loop itself.
+void benchmarkFreeListInit() {
+    const size_t BLOCK_SIZES[] = { 16, 64 };
+    const size_t POOL_SIZES[] = { 100000, 1000000, 10000000 };
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Free-List Init (reset)"
+              << std::right << std::setw(12) << "Chained(ms)"
+              << std::setw(12) << "Pool(ms)"
+              << std::setw(12) << "Speedup\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    for (size_t blockSize : BLOCK_SIZES) {
+        for (size_t numBlocks : POOL_SIZES) {
+            if (blockSize * numBlocks > 1024UL * 1024 * 1024) {
+                continue;
+            }
+            std::vector<char> reference(blockSize * numBlocks, 0);
+            auto start = high_resolution_clock::now();
+            linkChained(reference.data(), blockSize, numBlocks);
+            auto end = high_resolution_clock::now();
+            double chainedTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+            
+            start = high_resolution_clock::now();
+            MemoryPool pool(blockSize, numBlocks);
+            end = high_resolution_clock::now();
+            double constructTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+            
+            start = high_resolution_clock::now();
+            pool.reset();
+            end = high_resolution_clock::now();
+            double resetTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+            
+            std::string name = std::to_string(blockSize) + "B x " + std::to_string(numBlocks)
+                + " (ctor " + std::to_string(static_cast<int>(constructTime)) + "ms)";
+            printResult(name, chainedTime, resetTime, numBlocks);
+        }
+    }
+}
+
+// Benchmark: Constructor and reset time with the free list built by N threads
+void benchmarkParallelInit() {
+    const size_t BLOCK_SIZE = 64;
+    const size_t NUM_BLOCKS = 8 * 1024 * 1024;  // 512 MB
+    const size_t THREADS[] = { 2, 4, 8 };
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Parallel Init (64B x 8M, prefault)"
+              << std::right << std::setw(12) << "1 thread"
+              << std::setw(12) << "N threads"
+              << std::setw(12) << "Speedup\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    // Construction + one reset, in ms
+    auto timePool = [&](size_t threads, double& resetMs) {
+        PoolOptions options;
+        options.prefault = true;
+        options.initThreads = threads;
+        auto start = high_resolution_clock::now();
+        MemoryPool pool(BLOCK_SIZE, NUM_BLOCKS, options);
+        auto end = high_resolution_clock::now();
+        pool.reset();
+        auto resetEnd = high_resolution_clock::now();
+        resetMs = duration_cast<microseconds>(resetEnd - end).count() / 1000.0;
+        return duration_cast<microseconds>(end - start).count() / 1000.0;
+    };
+    
+    double serialReset;
+    double serialCtor = timePool(1, serialReset);
+    for (size_t threads : THREADS) {
+        double parallelReset;
+        double parallelCtor = timePool(threads, parallelReset);
+        printResult("Construct, " + std::to_string(threads) + " threads", serialCtor, parallelCtor, NUM_BLOCKS);
+        printResult("Reset, " + std::to_string(threads) + " threads", serialReset, parallelReset, NUM_BLOCKS);
+    }
+}
+
+void printLatencyHeader(const std::string& title) {
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << title
+              << std::right << std::setw(12) << "p50(ns)"
+              << std::setw(12) << "p99.9(ns)"
+              << std::setw(12) << "max(ns)\n";
+    std::cout << std::string(76, '-') << "\n";
+}
+
+// Latencies are sorted in place
+void printLatency(const std::string& name, std::vector<double>& latenciesNs) {
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    size_t n = latenciesNs.size();
+    std::cout << std::left << std::setw(40) << name
+              << std::right << std::setw(12) << std::fixed << std::setprecision(0) << latenciesNs[n / 2]
+              << std::setw(12) << latenciesNs[n - 1 - n / 1000]
+              << std::setw(12) << latenciesNs[n - 1] << "\n";
+}
+
+// First pass over every block of a pool, timing each allocate + first write
+std::vector<double> firstTouchLatencies(MemoryPool& pool) {
+    std::vector<double> latencies;
+    std::vector<void*> ptrs;
+    latencies.reserve(pool.getTotalBlocks());
+    ptrs.reserve(pool.getTotalBlocks());
+    
+    for (size_t i = 0; i < pool.getTotalBlocks(); ++i) {
+        auto start = high_resolution_clock::now();
+        void* p = pool.allocate();
+        use_pointer(p);
+        auto end = high_resolution_clock::now();
+        latencies.push_back(duration_cast<nanoseconds>(end - start).count());
+        ptrs.push_back(p);
+    }
+    for (void* p : ptrs) {
+        pool.deallocate(p);
+    }
+    return latencies;
+}
+
+// Benchmark: First-touch latency after trim(), with and without prefault + mlock
+void benchmarkFirstTouch() {
+    const size_t BLOCK_SIZE = 256;
+    const size_t NUM_BLOCKS = 16384;    // 4 MB, inside the default 8 MB mlock limit
+    
+    printLatencyHeader("First Allocation (256B x 16K)");
+    
+    MemoryPool lazy(BLOCK_SIZE, NUM_BLOCKS);
+    lazy.trim();                        // Pages handed back, faulted again on use
+    std::vector<double> lazyLatencies = firstTouchLatencies(lazy);
+    printLatency("Trimmed pool (demand faults)", lazyLatencies);
+    
+    PoolOptions options;
+    options.prefault = true;
+    options.lockMemory = true;
+    try {
+        MemoryPool resident(BLOCK_SIZE, NUM_BLOCKS, options);
+        resident.trim();                // No-op for resident pools
+        std::vector<double> residentLatencies = firstTouchLatencies(resident);
+        printLatency("Prefault + mlock pool", residentLatencies);
+    } catch (const std::exception& e) {
+        std::cout << YELLOW << "Prefault + mlock pool skipped: " << e.what() << RESET << "\n";
+    }
+}
+
+// Alloc/free one block in a tight loop; Pool is MemoryPool or a BasicPool
+template <class Pool>
+double tightLoop(Pool& pool, size_t iterations) {
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        void* p = pool.allocate();
+        use_pointer(p);
+        pool.deallocate(p);
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+struct LockedPoolConfig : DefaultPoolConfig {
+    typedef MutexLock LockPolicy;
+};
+
+// Benchmark: Out-of-line MemoryPool calls against the inlined BasicPool fast path
+void benchmarkBasicPool() {
+    const size_t ITERATIONS = 10000000;
+    const size_t BLOCK_SIZE = 32;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Header-only BasicPool"
+              << std::right << std::setw(12) << "Memory(ms)"
+              << std::setw(12) << "Basic(ms)"
+              << std::setw(12) << "Speedup\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    MemoryPool pool(BLOCK_SIZE, 1);
+    BasicPool<> basic(BLOCK_SIZE, 1);
+    double poolTime = tightLoop(pool, ITERATIONS);
+    double basicTime = tightLoop(basic, ITERATIONS);
+    printResult("Unlocked (32B, 10M ops)", poolTime, basicTime, ITERATIONS * 2);
+    
+    MemoryPool lockedPool(BLOCK_SIZE, 1, true);
+    BasicPool<LockedPoolConfig> lockedBasic(BLOCK_SIZE, 1);
+    poolTime = tightLoop(lockedPool, ITERATIONS);
+    basicTime = tightLoop(lockedBasic, ITERATIONS);
+    printResult("Mutex (32B, 10M ops)", poolTime, basicTime, ITERATIONS * 2);
+}
+
+struct ChainedGrowthConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef BoundsChecked SafetyPolicy;
+};
+
+struct ReservedGrowthConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef BoundsChecked SafetyPolicy;
+    typedef ReservedBacking<size_t(1) << 30> BackingPolicy;
+};
+
+struct GrowthRun {
+    double growMs;                  // Allocating every block, growth included
+    double freeMs;                  // Bounds-checked frees of every block
+    size_t chunks;
+};
+
+template <class Config>
+GrowthRun growToCapacity(size_t chunkBlocks, size_t blocks) {
+    GrowthRun run;
+    std::vector<void*> ptrs;
+    ptrs.reserve(blocks);
+    BasicPool<Config> pool(64, chunkBlocks);
+    
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < blocks; ++i) {
+        ptrs.push_back(pool.allocate());
+    }
+    auto end = high_resolution_clock::now();
+    run.growMs = duration_cast<microseconds>(end - start).count() / 1000.0;
+    run.chunks = pool.getChunkCount();
+    
+    start = high_resolution_clock::now();
+    for (void* ptr : ptrs) {
+        pool.deallocate(ptr);
+    }
+    end = high_resolution_clock::now();
+    run.freeMs = duration_cast<microseconds>(end - start).count() / 1000.0;
+    return run;
+}
+
+// Benchmark: Growing by malloc'd chunk chaining vs committing into one reservation
+void benchmarkReservedGrowth() {
+    const size_t CHUNK_BLOCKS = 1024;
+    const size_t BLOCKS = 256 * 1024;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Growth to 256K x 64B (1K-block chunks)"
+              << std::right << std::setw(12) << "Grow(ms)"
+              << std::setw(12) << "Free(ms)"
+              << std::setw(12) << "Chunks" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    GrowthRun runs[2] = {
+        growToCapacity<ChainedGrowthConfig>(CHUNK_BLOCKS, BLOCKS),
+        growToCapacity<ReservedGrowthConfig>(CHUNK_BLOCKS, BLOCKS)
+    };
+    const char* names[] = { "Chained malloc chunks", "Reserved range (1 GB)" };
+    for (size_t i = 0; i < 2; ++i) {
+        std::cout << std::left << std::setw(40) << names[i]
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << runs[i].growMs
+                  << std::setw(12) << runs[i].freeMs
+                  << std::setw(12) << runs[i].chunks << "\n";
+    }
+}
+
+// Mixed-size churn from several threads at once: each keeps a window of
+// live objects, mostly under 512 bytes with a tail up to 4 KB
+template <class Alloc, class Free>
+double mixedSizeChurn(size_t threads, size_t iterations, Alloc allocate, Free release) {
+    const size_t WINDOW = 64;
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+    
+    auto worker = [&](size_t seed) {
+        std::vector<std::pair<void*, size_t>> live(WINDOW, std::make_pair(nullptr, 0));
+        uint32_t state = static_cast<uint32_t>(seed * 2654435761u + 1);
+        ready.fetch_add(1);
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < iterations; ++i) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            size_t size = (state & 7) == 0 ? 512 + state % 3584 : 8 + (state >> 8) % 504;
+            std::pair<void*, size_t>& slot = live[i % WINDOW];
+            release(slot.first, slot.second);
+            slot.first = allocate(size);
+            slot.second = size;
+            use_pointer(slot.first);
+        }
+        for (auto& slot : live) {
+            release(slot.first, slot.second);
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, t);
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = high_resolution_clock::now();
+    go.store(true);
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: Small-object allocator against malloc, 1-64 threads
+void benchmarkSmallObjectScaling() {
+    const size_t ITERATIONS = 200000;   // Per thread
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Small-Object Allocator (8B-4KB mix)"
+              << std::right << std::setw(12) << "malloc(ms)"
+              << std::setw(12) << "Alloc(ms)"
+              << std::setw(12) << "Speedup\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    for (size_t threads = 1; threads <= 64; threads *= 2) {
+        double mallocTime = mixedSizeChurn(threads, ITERATIONS,
+            [](size_t size) { return std::malloc(size); },
+            [](void* ptr, size_t) { std::free(ptr); });
+        double allocatorTime = mixedSizeChurn(threads, ITERATIONS,
+            [](size_t size) { return SmallObjectAllocator::allocate(size); },
+            [](void* ptr, size_t size) { SmallObjectAllocator::deallocate(ptr, size); });
+        printResult(std::to_string(threads) + (threads == 1 ? " thread" : " threads") + ", 200K ops each",
+                    mallocTime, allocatorTime, threads * ITERATIONS * 2);
+    }
+}
+
+struct CacheRun {
+    double ms;
+    size_t footprintBytes;          // Slab metadata plus parked blocks
+};
+
+// Many threads churning one pool. Footprint is read while every thread is
+// still alive, since per-thread slabs are returned when threads exit.
+CacheRun cachedChurn(PoolCache cache, size_t threads, size_t iterations) {
+    const size_t BLOCK_SIZE = 64;
+    const size_t WINDOW = 8;
+    PoolOptions options;
+    options.threadSafe = true;
+    options.cache = cache;
+    MemoryPool pool(BLOCK_SIZE, threads * (WINDOW + 64) + 4096, options);
+    
+    std::atomic<size_t> ready(0), finished(0);
+    std::atomic<bool> go(false), exit(false);
+    auto worker = [&]() {
+        std::vector<void*> live(WINDOW, nullptr);
+        ready.fetch_add(1);
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < iterations; ++i) {
+            size_t slot = i % WINDOW;
+            pool.deallocate(live[slot]);
+            live[slot] = pool.allocate();
+            use_pointer(live[slot]);
+        }
+        for (void* ptr : live) {
+            pool.deallocate(ptr);
+        }
+        finished.fetch_add(1);
+        while (!exit.load()) {
+            std::this_thread::yield();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = high_resolution_clock::now();
+    go.store(true);
+    while (finished.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto end = high_resolution_clock::now();
+    
+    CacheStats stats = pool.getCacheStats();
+    exit.store(true);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    CacheRun run;
+    run.ms = duration_cast<microseconds>(end - start).count() / 1000.0;
+    run.footprintBytes = (cache == PoolCache::None) ? 0 : stats.slabs * 2048 + stats.cachedBlocks * pool.getBlockSize();
+    return run;
+}
+
+// Benchmark: Per-CPU against per-thread caches with many more threads than CPUs
+void benchmarkBlockCaches() {
+    const size_t ITERATIONS = 20000;    // Per thread
+    size_t cpus = std::max<size_t>(1, std::thread::hardware_concurrency());
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << "Block Caches (64B, " << cpus << " CPUs, 20K ops/thread)\n";
+    std::cout << std::left << std::setw(28) << "Threads / mode"
+              << std::right << std::setw(12) << "Time(ms)"
+              << std::setw(12) << "Mops/s"
+              << std::setw(16) << "Footprint(KB)" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    const char* names[] = { "mutex", "per-thread", "per-CPU" };
+    PoolCache modes[] = { PoolCache::None, PoolCache::PerThread, PoolCache::PerCpu };
+    for (size_t perCpu : { 4, 32, 256 }) {
+        size_t threads = cpus * perCpu;
+        for (size_t m = 0; m < 3; ++m) {
+            CacheRun run = cachedChurn(modes[m], threads, ITERATIONS);
+            std::cout << std::left << std::setw(28) << (std::to_string(threads) + " / " + names[m])
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(2) << run.ms
+                      << std::setw(12) << threads * ITERATIONS * 2 / run.ms / 1000.0
+                      << std::setw(16) << run.footprintBytes / 1024.0 << "\n";
+        }
+    }
+}
+
+// Read-mostly table of pool-allocated nodes: readers look entries up while
+// one writer keeps replacing them. Returns the time for the readers' work.
+template <class Read, class Write>
+double readMostly(size_t readers, size_t reads, Read read, Write write) {
+    std::atomic<size_t> running(readers);
+    std::vector<std::thread> threads;
+    auto start = high_resolution_clock::now();
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r]() {
+            for (size_t i = 0; i < reads; ++i) {
+                sink += static_cast<int>(read(i * 7 + r));
+            }
+            running.fetch_sub(1);
+        });
+    }
+    threads.emplace_back([&]() {
+        for (size_t i = 0; running.load() > 0; ++i) {
+            write(i);
+            std::this_thread::yield();
+        }
+    });
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: Epoch-protected lock-free reads against a reader-writer lock.
+// The tree is C++11, so pthread_rwlock stands in for std::shared_mutex.
+void benchmarkEpochReclaimer() {
+    const size_t SLOTS = 256;
+    const size_t READERS = 3;
+    const size_t READS = 2000000;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Read-Mostly Table (3R + 1W)"
+              << std::right << std::setw(12) << "rwlock(ms)"
+              << std::setw(12) << "Epoch(ms)"
+              << std::setw(12) << "Speedup\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    // rwlock: readers share the lock, the writer swaps nodes under it
+    MemoryPool lockedPool(64, SLOTS * 2, true);
+    std::vector<uint64_t*> lockedTable(SLOTS);
+    for (auto& node : lockedTable) {
+        node = static_cast<uint64_t*>(lockedPool.allocate());
+        node[0] = 1;
+    }
+    pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+    double lockedTime = readMostly(READERS, READS,
+        [&](size_t i) {
+            pthread_rwlock_rdlock(&rwlock);
+            uint64_t value = lockedTable[i % SLOTS][0];
+            pthread_rwlock_unlock(&rwlock);
+            return value;
+        },
+        [&](size_t i) {
+            uint64_t* node = static_cast<uint64_t*>(lockedPool.allocate());
+            node[0] = i;
+            pthread_rwlock_wrlock(&rwlock);
+            std::swap(node, lockedTable[i % SLOTS]);
+            pthread_rwlock_unlock(&rwlock);
+            lockedPool.deallocate(node);
+        });
+    for (uint64_t* node : lockedTable) {
+        lockedPool.deallocate(node);
+    }
+    
+    // Epoch: readers only pin an epoch; replaced nodes are retired
+    MemoryPool epochPool(64, SLOTS + 8192, true);
+    std::vector<std::atomic<uint64_t*>> epochTable(SLOTS);
+    for (auto& slot : epochTable) {
+        uint64_t* node = static_cast<uint64_t*>(epochPool.allocate());
+        node[0] = 1;
+        slot.store(node);
+    }
+    double epochTime;
+    {
+        EpochReclaimer reclaimer(epochPool, 64, 4096);
+        epochTime = readMostly(READERS, READS,
+            [&](size_t i) {
+                EpochReclaimer::Guard guard(reclaimer);
+                return epochTable[i % SLOTS].load(std::memory_order_acquire)[0];
+            },
+            [&](size_t i) {
+                uint64_t* node = static_cast<uint64_t*>(epochPool.allocate());
+                node[0] = i;
+                reclaimer.retire(epochTable[i % SLOTS].exchange(node));
+            });
+        for (auto& slot : epochTable) {
+            reclaimer.retire(slot.load());
+        }
+    }
+    
+    printResult("6M lookups, writer replacing nodes", lockedTime, epochTime, READERS * READS);
+}
+
+// Threads hammering one pool's head with a balanced mix: each round frees
+// the oldest of a few held blocks and allocates a replacement
+double contendedChurn(const PoolOptions& options, size_t threads, size_t iterations) {
+    const size_t WINDOW = 4;
+    MemoryPool pool(64, threads * WINDOW + 1024, options);
+    
+    std::atomic<size_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            std::vector<void*> live(WINDOW, nullptr);
+            ready.fetch_add(1);
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < iterations; ++i) {
+                size_t slot = i % WINDOW;
+                pool.deallocate(live[slot]);
+                live[slot] = pool.allocate();
+                use_pointer(live[slot]);
+            }
+            for (void* ptr : live) {
+                pool.deallocate(ptr);
+            }
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    auto start = high_resolution_clock::now();
+    go.store(true);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: Mutex against the lock-free head, with and without elimination
+void benchmarkLockFreeContention() {
+    const size_t ITERATIONS = 100000;   // Per thread
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << "Contended Free List (64B, balanced alloc/free, 100K ops/thread)\n";
+    std::cout << std::left << std::setw(28) << "Threads / mode"
+              << std::right << std::setw(12) << "Time(ms)"
+              << std::setw(12) << "Mops/s" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    PoolOptions modes[3];
+    modes[0].threadSafe = true;
+    modes[1].lockFree = true;
+    modes[2].lockFree = true;
+    modes[2].eliminationSlots = 8;
+    const char* names[] = { "mutex", "lock-free", "lock-free + elimination" };
+    for (size_t threads : { 4, 16, 64 }) {
+        for (size_t m = 0; m < 3; ++m) {
+            double ms = contendedChurn(modes[m], threads, ITERATIONS);
+            std::cout << std::left << std::setw(28) << (std::to_string(threads) + " / " + names[m])
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(2) << ms
+                      << std::setw(12) << threads * ITERATIONS * 2 / ms / 1000.0 << "\n";
+        }
+    }
+}
+
+// Benchmark: Flat combining against the mutex and the lock-free head
+void benchmarkFlatCombining() {
+    const size_t ITERATIONS = 50000;    // Per thread
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    // Combining only pays off when threads on different cores contend
+    std::cout << "Flat Combining (64B, balanced alloc/free, 50K ops/thread, "
+              << std::thread::hardware_concurrency() << " CPUs)\n";
+    std::cout << std::left << std::setw(28) << "Threads / mode"
+              << std::right << std::setw(12) << "Time(ms)"
+              << std::setw(12) << "Mops/s" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    PoolOptions modes[3];
+    modes[0].threadSafe = true;
+    modes[1].lockFree = true;
+    modes[2].flatCombining = true;
+    const char* names[] = { "mutex", "lock-free", "flat combining" };
+    for (size_t threads : { 2, 8, 32, 64 }) {
+        for (size_t m = 0; m < 3; ++m) {
+            double ms = contendedChurn(modes[m], threads, ITERATIONS);
+            std::cout << std::left << std::setw(28) << (std::to_string(threads) + " / " + names[m])
+                      << std::right << std::setw(12) << std::fixed << std::setprecision(2) << ms
+                      << std::setw(12) << threads * ITERATIONS * 2 / ms / 1000.0 << "\n";
+        }
+    }
+}
+
+// Per-call allocate latency seen by client threads churning a small window
+template <class Alloc, class Free>
+std::vector<double> clientLatencies(size_t clients, size_t iterations, Alloc alloc, Free release) {
+    const size_t WINDOW = 8;
+    std::vector<std::vector<double>> perClient(clients);
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            std::vector<double>& latencies = perClient[c];
+            latencies.reserve(iterations);
+            std::vector<void*> live(WINDOW, nullptr);
+            for (size_t i = 0; i < iterations; ++i) {
+                size_t slot = i % WINDOW;
+                if (live[slot]) {
+                    release(c, live[slot]);
+                }
+                auto start = high_resolution_clock::now();
+                live[slot] = alloc(c);
+                auto end = high_resolution_clock::now();
+                use_pointer(live[slot]);
+                latencies.push_back(duration_cast<nanoseconds>(end - start).count());
+            }
+            for (void* ptr : live) {
+                release(c, ptr);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::vector<double> all;
+    for (std::vector<double>& latencies : perClient) {
+        all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+    return all;
+}
+
+// Benchmark: Client-side allocate latency, delegated against a mutex pool
+void benchmarkDelegatedAllocator() {
+    const size_t CLIENTS = 4;
+    const size_t ITERATIONS = 100000;   // Per client
+    
+    printLatencyHeader("Client allocate (4 clients, 64B)");
+    
+    MemoryPool locked(64, 4096, true);
+    std::vector<double> latencies = clientLatencies(CLIENTS, ITERATIONS,
+        [&](size_t) { return locked.allocate(); },
+        [&](size_t, void* ptr) { locked.deallocate(ptr); });
+    printLatency("Mutex pool", latencies);
+    
+    MemoryPool pool(64, 4096, false);
+    {
+        DelegatedAllocator delegated(pool, 64);
+        std::vector<DelegatedAllocator::Client*> clients;
+        for (size_t c = 0; c < CLIENTS; ++c) {
+            clients.push_back(&delegated.registerClient());
+        }
+        latencies = clientLatencies(CLIENTS, ITERATIONS,
+            [&](size_t c) { return clients[c]->allocate(); },
+            [&](size_t c, void* ptr) { clients[c]->deallocate(ptr); });
+        printLatency("Delegated (SPSC rings)", latencies);
+    }
+}
+
+struct PipelineRun {
+    double ms;
+    double producerCpuMs;           // CPU the producer burned, waiting included
+};
+
+// A producer fills blocks faster than a consumer drains them, so it spends
+// most of its time waiting on an exhausted pool
+template <class Acquire>
+PipelineRun boundedPipeline(size_t items, Acquire acquire) {
+    const size_t BLOCKS = 64;
+    MemoryPool pool(64, BLOCKS, true);
+    SpscRing<void*> queue(BLOCKS);
+    
+    auto start = high_resolution_clock::now();
+    double producerCpuMs = 0;
+    std::thread producer([&]() {
+        for (size_t i = 0; i < items; ++i) {
+            void* block = acquire(pool);
+            use_pointer(block);
+            while (!queue.push(block)) {
+                std::this_thread::yield();
+            }
+        }
+        timespec cpu;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+        producerCpuMs = cpu.tv_sec * 1000.0 + cpu.tv_nsec / 1e6;
+    });
+    for (size_t i = 0; i < items; ++i) {
+        void* block;
+        while (!queue.pop(block)) {
+            std::this_thread::yield();
+        }
+        // Simulated downstream work, about 20us per item
+        auto busyUntil = high_resolution_clock::now() + microseconds(20);
+        while (high_resolution_clock::now() < busyUntil) {
+        }
+        pool.deallocate(block);
+    }
+    producer.join();
+    auto end = high_resolution_clock::now();
+    
+    PipelineRun run;
+    run.ms = duration_cast<microseconds>(end - start).count() / 1000.0;
+    run.producerCpuMs = producerCpuMs;
+    return run;
+}
+
+// Benchmark: Waiting for a free block by polling against allocateWait()
+void benchmarkAllocateWait() {
+    const size_t ITEMS = 20000;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << "Bounded Pipeline (64 blocks, 20K items, 20us consumer work)\n";
+    std::cout << std::left << std::setw(40) << "Producer waits by"
+              << std::right << std::setw(12) << "Time(ms)"
+              << std::setw(18) << "Producer CPU(ms)" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    PipelineRun runs[3];
+    runs[0] = boundedPipeline(ITEMS, [](MemoryPool& pool) {
+        void* block;
+        while (!(block = pool.allocate())) {
+            std::this_thread::yield();
+        }
+        return block;
+    });
+    runs[1] = boundedPipeline(ITEMS, [](MemoryPool& pool) {
+        void* block;
+        while (!(block = pool.allocate())) {
+            std::this_thread::sleep_for(microseconds(50));
+        }
+        return block;
+    });
+    runs[2] = boundedPipeline(ITEMS, [](MemoryPool& pool) {
+        return pool.allocateWait(seconds(10));
+    });
+    const char* names[] = { "Spin (yield) polling", "Sleep polling (50us)", "allocateWait (futex)" };
+    for (size_t i = 0; i < 3; ++i) {
+        std::cout << std::left << std::setw(40) << names[i]
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << runs[i].ms
+                  << std::setw(18) << runs[i].producerCpuMs << "\n";
+    }
+}
+
+// Event loop waiting on an exhausted one-block pool while another thread
+// frees the block; each sample is free -> block in hand on the loop. With
+// polled, the loop retries allocate() on a 1ms epoll tick instead.
+std::vector<double> loopWakeLatencies(size_t rounds, bool polled) {
+    MemoryPool pool(64, 1, true);
+    AsyncAllocator async(pool);
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    if (!polled) {
+        epoll_ctl(epfd, EPOLL_CTL_ADD, async.getEventFd(), &event);
+    }
+    
+    std::atomic<void*> handBack(pool.allocate());
+    std::atomic<int64_t> freedAt(0);
+    std::thread freer([&]() {
+        for (size_t i = 0; i < rounds; ++i) {
+            void* block;
+            while (!(block = handBack.exchange(nullptr))) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(microseconds(50));
+            freedAt.store(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+            pool.deallocate(block);
+        }
+    });
+    
+    std::vector<double> latencies;
+    latencies.reserve(rounds);
+    for (size_t i = 0; i < rounds; ++i) {
+        void* got = nullptr;
+        if (polled) {
+            while (!(got = pool.allocate())) {
+                epoll_wait(epfd, &event, 1, 1);
+            }
+        } else {
+            got = async.allocate([&got](void* block) { got = block; });
+            while (!got) {
+                if (epoll_wait(epfd, &event, 1, -1) == 1) {
+                    async.dispatch();
+                }
+            }
+        }
+        int64_t now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+        latencies.push_back(static_cast<double>(now - freedAt.load()));
+        handBack.store(got);
+    }
+    freer.join();
+    pool.deallocate(handBack.load());
+    close(epfd);
+    return latencies;
+}
+
+// Benchmark: Exhausted-pool wakeup latency of an epoll loop
+void benchmarkAsyncAllocator() {
+    const size_t ROUNDS = 1000;
+    
+    printLatencyHeader("Loop gets a freed block (1K rounds)");
+    std::vector<double> latencies = loopWakeLatencies(ROUNDS, true);
+    printLatency("Retry on 1ms epoll tick", latencies);
+    latencies = loopWakeLatencies(ROUNDS, false);
+    printLatency("AsyncAllocator eventfd", latencies);
+}
+
+// Benchmark: Finding a block's owner among many pools
+void benchmarkOwnerLookup() {
+    const size_t LOOKUPS = 4000000;
+    const size_t BLOCKS_PER_POOL = 256;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Owner lookup (random live blocks)"
+              << std::right << std::setw(12) << "Scan(ns)"
+              << std::setw(12) << "Mask(ns)"
+              << std::setw(12) << "Speedup" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    for (size_t poolCount : { 4, 16, 64 }) {
+        std::vector<std::unique_ptr<MemoryPool>> pools;
+        std::vector<std::unique_ptr<AlignedChunkPool>> chunked;
+        std::vector<void*> blocks;
+        std::vector<void*> chunkedBlocks;
+        for (size_t i = 0; i < poolCount; ++i) {
+            pools.emplace_back(new MemoryPool(64, BLOCKS_PER_POOL));
+            chunked.emplace_back(new AlignedChunkPool({ 64 }));
+            for (size_t b = 0; b < BLOCKS_PER_POOL; ++b) {
+                blocks.push_back(pools.back()->allocate());
+                chunkedBlocks.push_back(chunked.back()->allocate(64));
+            }
+        }
+        // Same shuffled order for both
+        std::vector<size_t> order(LOOKUPS);
+        uint64_t seed = 88172645463325252ull;
+        for (size_t& index : order) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            index = seed % blocks.size();
+        }
+        
+        size_t found = 0;
+        auto start = high_resolution_clock::now();
+        for (size_t index : order) {
+            void* ptr = blocks[index];
+            for (const auto& pool : pools) {
+                if (pool->owns(ptr)) {
+                    found += reinterpret_cast<uintptr_t>(pool.get()) & 1;
+                    break;
+                }
+            }
+        }
+        auto end = high_resolution_clock::now();
+        double scanNs = duration_cast<nanoseconds>(end - start).count() / double(LOOKUPS);
+        
+        start = high_resolution_clock::now();
+        for (size_t index : order) {
+            found += reinterpret_cast<uintptr_t>(AlignedChunkPool::ownerOf(chunkedBlocks[index])) & 1;
+        }
+        end = high_resolution_clock::now();
+        double maskNs = duration_cast<nanoseconds>(end - start).count() / double(LOOKUPS);
+        use_pointer(reinterpret_cast<void*>(found));
+        
+        std::cout << std::left << std::setw(40) << (std::to_string(poolCount) + " pools")
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << scanNs
+                  << std::setw(12) << maskNs
+                  << std::setw(11) << scanNs / maskNs << "x\n";
+        
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            pools[i / BLOCKS_PER_POOL]->deallocate(blocks[i]);
+            chunked[i / BLOCKS_PER_POOL]->deallocate(chunkedBlocks[i]);
+        }
+    }
+}
+
+// Region table the small-object allocator used to scan before its page map
+struct ScannedRegion {
+    uintptr_t firstPage;
+    size_t pages;
+    std::vector<int*> map;
+};
+
+// Benchmark: Page-to-metadata lookup, region scan vs radix page map
+void benchmarkPageMap() {
+    const size_t PAGE_SHIFT = 13;
+    const size_t REGION_PAGES = (64 * 1024 * 1024) >> PAGE_SHIFT;
+    const size_t LOOKUPS = 4000000;
+    typedef PageMap<int, PAGE_SHIFT> Map;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Page lookup (8 KB pages, 64 MB regions)"
+              << std::right << std::setw(12) << "Scan(ns)"
+              << std::setw(12) << "Radix(ns)"
+              << std::setw(12) << "Radix KB" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    int value = 0;
+    for (size_t regionCount : { 1, 16, 256 }) {
+        // Regions at random 64 MB-aligned spots of the 48-bit space
+        std::vector<ScannedRegion> regions(regionCount);
+        std::unique_ptr<Map> map(new Map());
+        uint64_t seed = 88172645463325252ull;
+        auto next = [&seed]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            return seed;
+        };
+        for (ScannedRegion& region : regions) {
+            region.firstPage = (next() % ((uintptr_t(1) << 47) / (REGION_PAGES << PAGE_SHIFT))) * REGION_PAGES;
+            region.pages = REGION_PAGES;
+            region.map.assign(REGION_PAGES, &value);
+            map->ensure(region.firstPage, REGION_PAGES);
+            for (size_t page = 0; page < REGION_PAGES; ++page) {
+                map->set(region.firstPage + page, &value);
+            }
+        }
+        std::vector<uintptr_t> pages(LOOKUPS);
+        for (uintptr_t& page : pages) {
+            const ScannedRegion& region = regions[next() % regionCount];
+            page = region.firstPage + next() % REGION_PAGES;
+        }
+        
+        size_t found = 0;
+        auto start = high_resolution_clock::now();
+        for (uintptr_t page : pages) {
+            for (const ScannedRegion& region : regions) {
+                if (page - region.firstPage < region.pages) {
+                    found += *region.map[page - region.firstPage];
+                    break;
+                }
+            }
+        }
+        auto end = high_resolution_clock::now();
+        double scanNs = duration_cast<nanoseconds>(end - start).count() / double(LOOKUPS);
+        
+        start = high_resolution_clock::now();
+        for (uintptr_t page : pages) {
+            found += *map->get(page);
+        }
+        end = high_resolution_clock::now();
+        double radixNs = duration_cast<nanoseconds>(end - start).count() / double(LOOKUPS);
+        use_pointer(reinterpret_cast<void*>(found));
+        
+        std::cout << std::left << std::setw(40) << (std::to_string(regionCount) + " region(s)")
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << scanNs
+                  << std::setw(12) << radixNs
+                  << std::setw(12) << std::setprecision(0) << (sizeof(Map) + map->getNodeBytes()) / 1024.0 << "\n";
+    }
+    std::cout << "Radix KB includes the " << sizeof(Map) / 1024 << " KB root; a flat map costs "
+              << REGION_PAGES * sizeof(void*) / 1024 << " KB per region\n";
+}
+
+void benchmarkBitmapPool() {
+    const size_t POOL_BLOCKS = 64 * 1024;
+    const size_t BLOCKS_PER_ROUND = 16 * 1024;
+    const size_t ROUNDS = 200;
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Group of n 64 B blocks (alloc + free)"
+              << std::right << std::setw(12) << "Separate(ns)"
+              << std::setw(12) << "Run(ns)"
+              << std::setw(12) << "Adjacent%" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    uint64_t seed = 88172645463325252ull;
+    auto next = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+    
+    for (size_t n : { 1, 4, 16 }) {
+        size_t groups = BLOCKS_PER_ROUND / n;
+        
+        // A pool that has seen churn: its free list is in shuffled order
+        MemoryPool pool(64, POOL_BLOCKS);
+        std::vector<void*> blocks(POOL_BLOCKS);
+        for (void*& block : blocks) {
+            block = pool.allocate();
+        }
+        for (size_t i = POOL_BLOCKS - 1; i > 0; --i) {
+            std::swap(blocks[i], blocks[next() % (i + 1)]);
+        }
+        for (void* block : blocks) {
+            pool.deallocate(block);
+        }
+        
+        std::vector<char*> group(n);
+        std::vector<char*> held(BLOCKS_PER_ROUND);
+        size_t adjacent = 0;
+        auto start = high_resolution_clock::now();
+        for (size_t round = 0; round < ROUNDS; ++round) {
+            for (size_t g = 0; g < groups; ++g) {
+                bool together = true;
+                for (size_t i = 0; i < n; ++i) {
+                    held[g * n + i] = static_cast<char*>(pool.allocate());
+                    together = together && (i == 0 || held[g * n + i] == held[g * n + i - 1] + 64);
+                }
+                adjacent += together;
+            }
+            for (size_t i = 0; i < BLOCKS_PER_ROUND; ++i) {
+                pool.deallocate(held[i]);
+            }
+        }
+        auto end = high_resolution_clock::now();
+        double separateNs = duration_cast<nanoseconds>(end - start).count() / double(ROUNDS * groups);
+        
+        BitmapPool bitmap(64, POOL_BLOCKS);
+        start = high_resolution_clock::now();
+        for (size_t round = 0; round < ROUNDS; ++round) {
+            for (size_t g = 0; g < groups; ++g) {
+                held[g] = static_cast<char*>(bitmap.allocateContiguous(n));
+            }
+            for (size_t g = 0; g < groups; ++g) {
+                bitmap.deallocateContiguous(held[g], n);
+            }
+        }
+        end = high_resolution_clock::now();
+        double runNs = duration_cast<nanoseconds>(end - start).count() / double(ROUNDS * groups);
+        use_pointer(held[0]);
+        
+        std::cout << std::left << std::setw(40) << ("n = " + std::to_string(n))
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << separateNs
+                  << std::setw(12) << runNs
+                  << std::setw(11) << std::setprecision(1) << 100.0 * adjacent / (ROUNDS * groups) << "%\n";
+    }
+    
+    // Scattered frees leave plenty free but few long runs
+    BitmapPool bitmap(64, POOL_BLOCKS);
+    std::vector<void*> runs;
+    for (void* run; (run = bitmap.allocateContiguous(4)) != nullptr;) {
+        runs.push_back(run);
+    }
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (next() % 2 == 0) {
+            bitmap.deallocateContiguous(runs[i], 4);
+            runs[i] = nullptr;
+        }
+    }
+    auto start = high_resolution_clock::now();
+    BitmapPoolStats stats = bitmap.getStats();
+    auto end = high_resolution_clock::now();
+    std::cout << "Half of the n = 4 runs freed at random: " << stats.freeBlocks << " free in "
+              << stats.freeRuns << " runs, largest " << stats.largestFreeRun << ", fragmentation "
+              << std::setprecision(3) << stats.fragmentation << " (stats took "
+              << duration_cast<microseconds>(end - start).count() << " us)\n";
+    for (void* run : runs) {
+        if (run) {
+            bitmap.deallocateContiguous(run, 4);
+        }
+    }
+}
+
+// Threads churning a window of blocks through alloc and release
+template <class Alloc, class Free>
+double windowChurn(size_t threads, size_t iterations, Alloc alloc, Free release) {
+    const size_t WINDOW = 8;
+    std::vector<std::thread> workers;
+    auto start = high_resolution_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::vector<void*> live(WINDOW, nullptr);
+            for (size_t i = 0; i < iterations; ++i) {
+                size_t slot = i % WINDOW;
+                if (live[slot]) {
+                    release(t, live[slot]);
+                }
+                live[slot] = alloc(t);
+                use_pointer(live[slot]);
+            }
+            for (void* ptr : live) {
+                if (ptr) {
+                    release(t, ptr);
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    auto end = high_resolution_clock::now();
+    return duration_cast<microseconds>(end - start).count() / 1000.0;
+}
+
+// Benchmark: Tenant accounting against the plain thread-safe pool
+void benchmarkTenantQuotas() {
+    const size_t ITERATIONS = 200000;   // Per thread
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Tenant accounting (64B, 200K ops/thread)"
+              << std::right << std::setw(12) << "Pool(ms)"
+              << std::setw(12) << "Tenant(ms)"
+              << std::setw(12) << "Overhead" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    for (size_t threads : { 1, 4 }) {
+        MemoryPool pool(64, 4096, true);
+        double poolMs = windowChurn(threads, ITERATIONS,
+            [&](size_t) { return pool.allocate(); },
+            [&](size_t, void* ptr) { pool.deallocate(ptr); });
+        
+        // One tenant per thread, half of each one's blocks shared
+        TenantPool tenants(pool);
+        std::vector<TenantPool::Tenant*> list;
+        for (size_t t = 0; t < threads; ++t) {
+            list.push_back(&tenants.addTenant(64, 4));
+        }
+        double tenantMs = windowChurn(threads, ITERATIONS,
+            [&](size_t t) { return list[t]->allocate(); },
+            [&](size_t t, void* ptr) { list[t]->deallocate(ptr); });
+        
+        std::cout << std::left << std::setw(40) << (std::to_string(threads) + " thread(s), 1 tenant each")
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << poolMs
+                  << std::setw(12) << tenantMs
+                  << std::setw(11) << (tenantMs / poolMs - 1.0) * 100.0 << "%\n";
+    }
+}
+
+// Benchmark: Normal-path cost of a high-priority reserve
+void benchmarkPriorityReserve() {
+    const size_t ITERATIONS = 500000;   // Per thread
+    
+    std::cout << BOLD << std::string(76, '=') << RESET << "\n";
+    std::cout << std::left << std::setw(40) << "Priority reserve (64B, 500K ops/thread)"
+              << std::right << std::setw(12) << "None(ms)"
+              << std::setw(12) << "Reserve(ms)"
+              << std::setw(12) << "Overhead" << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    
+    for (size_t threads : { 1, 4 }) {
+        double times[2];
+        for (int withReserve = 0; withReserve < 2; ++withReserve) {
+            PoolOptions options;
+            options.threadSafe = threads > 1;
+            options.highPriorityReserve = withReserve ? 256 : 0;
+            MemoryPool pool(64, 4096, options);
+            times[withReserve] = windowChurn(threads, ITERATIONS,
+                [&](size_t) { return pool.allocate(); },
+                [&](size_t, void* ptr) { pool.deallocate(ptr); });
+        }
+        std::cout << std::left << std::setw(40) << (std::to_string(threads) + " thread(s), low priority")
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << times[0]
+                  << std::setw(12) << times[1]
+                  << std::setw(11) << (times[1] / times[0] - 1.0) * 100.0 << "%\n";
+    }
+}
+
 int main() {
     std::cout << BOLD << CYAN;
     std::cout << "╔════════════════════════════════════════════════════════════════════╗\n";
@@ -291,6 +1620,66 @@ int main() {
     
     std::cout << std::string(76, '=') << "\n\n";
     
+    printOverheadHeader();
+    benchmarkQuarantine();
+    benchmarkHeapProfiler();
+    benchmarkZeroed();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkFirstTouch();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkFreeListInit();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkParallelInit();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkBasicPool();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkReservedGrowth();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkOwnerLookup();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkPageMap();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkBitmapPool();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkSmallObjectScaling();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkBlockCaches();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkEpochReclaimer();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkLockFreeContention();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkFlatCombining();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkDelegatedAllocator();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkAllocateWait();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkAsyncAllocator();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkTenantQuotas();
+    std::cout << std::string(76, '=') << "\n\n";
+    
+    benchmarkPriorityReserve();
+    std::cout << std::string(76, '=') << "\n\n";
+    
     std::cout << GREEN << BOLD << "Expected Results:\n" << RESET;
     std::cout << "  • Ultra-tight loops: 2-5x speedup\n";
     std::cout << "  • Tiny allocations: 3-8x speedup\n";
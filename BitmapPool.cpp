@@ -0,0 +1,248 @@
+#include "BitmapPool.h"
+#include "MemoryPressure.h"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t NO_RUN = SIZE_MAX;
+const size_t PAD_WORDS = 4;
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// First word at or after i with a free bit, or end. Fully allocated words
+// are compared four (AVX2) or two (SSE2) at a time; the padding after end
+// keeps the wide loads inside the array.
+size_t skipAllocated(const uint64_t* words, size_t i, size_t end) {
+#if defined(__AVX2__)
+    for (; i + 4 <= end; i += 4) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_setzero_si256())) != -1) {
+            break;
+        }
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= end; i += 2) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_setzero_si128())) != 0xFFFF) {
+            break;
+        }
+    }
+#endif
+    while (i < end && words[i] == 0) {
+        ++i;
+    }
+    return i;
+}
+
+// Bits of word covering blocks [first, first + count)
+uint64_t wordMask(size_t word, size_t first, size_t count) {
+    size_t low = std::max(first, word * 64) - word * 64;
+    size_t high = std::min(first + count, word * 64 + 64) - word * 64;
+    uint64_t mask = high == 64 ? ~uint64_t(0) : (uint64_t(1) << high) - 1;
+    return mask & ~((uint64_t(1) << low) - 1);
+}
+
+// Length of the longest run of set bits in w
+size_t longestRun(uint64_t w) {
+    size_t length = 0;
+    for (; w != 0; w &= w >> 1) {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace
+
+BitmapPool::BitmapPool(size_t blockSize, size_t numBlocks, bool threadSafe)
+    : memoryStart(nullptr)
+    , blockSize((std::max<size_t>(blockSize, 1) + 15) & ~size_t(15))
+    , totalBlocks(numBlocks)
+    , freeBlockCount(numBlocks)
+    , mappedBytes(0)
+    , threadSafe(threadSafe)
+    , usedWords((numBlocks + 63) / 64)
+    , firstFreeWord(0) {
+    if (numBlocks == 0) {
+        throw std::invalid_argument("Number of blocks must be greater than 0");
+    }
+    words.assign(usedWords + PAD_WORDS, 0);
+    std::fill(words.begin(), words.begin() + numBlocks / 64, ~uint64_t(0));
+    if (numBlocks % 64 != 0) {
+        words[numBlocks / 64] = (uint64_t(1) << (numBlocks % 64)) - 1;
+    }
+
+    // A fixed pool, like MemoryPool: counted by MemoryPressure, never refused
+    mappedBytes = (this->blockSize * numBlocks + pageSize() - 1) & ~(pageSize() - 1);
+    MemoryPressure::reserve(mappedBytes, false);
+    void* mapped = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        MemoryPressure::release(mappedBytes, false);
+        throw std::bad_alloc();
+    }
+    memoryStart = static_cast<char*>(mapped);
+}
+
+BitmapPool::~BitmapPool() {
+    munmap(memoryStart, mappedBytes);
+    MemoryPressure::release(mappedBytes, false);
+}
+
+void* BitmapPool::allocateContiguous(size_t n) {
+    if (n == 0 || n > totalBlocks) {
+        return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    if (n > freeBlockCount) {
+        return nullptr;
+    }
+    size_t first = findRun(n);
+    if (first == NO_RUN) {
+        return nullptr;
+    }
+    markRange(first, n, false);
+    freeBlockCount -= n;
+    if (first / 64 == firstFreeWord) {
+        firstFreeWord = skipAllocated(words.data(), firstFreeWord, usedWords);
+    }
+    return memoryStart + first * blockSize;
+}
+
+void BitmapPool::deallocateContiguous(void* ptr, size_t n) {
+    if (!ptr || n == 0) {
+        return;
+    }
+    size_t first = static_cast<size_t>(static_cast<char*>(ptr) - memoryStart) / blockSize;
+
+    #ifdef MEMPOOL_SAFE_MODE
+    char* ptrAddr = static_cast<char*>(ptr);
+    if (ptrAddr < memoryStart || ptrAddr >= memoryStart + blockSize * totalBlocks
+        || (ptrAddr - memoryStart) % blockSize != 0 || n > totalBlocks - first) {
+        throw std::invalid_argument("Pointer not from this pool");
+    }
+    #endif
+
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+
+    #ifdef MEMPOOL_SAFE_MODE
+    for (size_t word = first / 64; word <= (first + n - 1) / 64; ++word) {
+        if (words[word] & wordMask(word, first, n)) {
+            throw std::invalid_argument("Block already free");
+        }
+    }
+    #endif
+
+    markRange(first, n, true);
+    freeBlockCount += n;
+    firstFreeWord = std::min(firstFreeWord, first / 64);
+}
+
+// Lock held. Index of the lowest block starting n free blocks, or NO_RUN.
+size_t BitmapPool::findRun(size_t n) {
+    const uint64_t* bits = words.data();
+    size_t i = skipAllocated(bits, firstFreeWord, usedWords);
+
+    if (n == 1) {
+        return i < usedWords ? i * 64 + __builtin_ctzll(bits[i]) : NO_RUN;
+    }
+
+    if (n <= 64) {
+        // Fold the pair (bits[i + 1]:bits[i]) onto itself until bit k of
+        // the low word is set only if bits k .. k + n - 1 all are. Each
+        // step doubles the covered length, so this is log2(n) shifts.
+        for (; i < usedWords; i = skipAllocated(bits, i + 1, usedWords)) {
+            uint64_t low = bits[i];
+            uint64_t high = bits[i + 1];
+            for (size_t covered = 1; covered < n && low != 0;) {
+                size_t shift = std::min(covered, n - covered);
+                low &= (low >> shift) | (high << (64 - shift));
+                high &= high >> shift;
+                covered += shift;
+            }
+            if (low != 0) {
+                return i * 64 + __builtin_ctzll(low);
+            }
+        }
+        return NO_RUN;
+    }
+
+    // Longer runs span whole free words: count the trailing free bits of
+    // each word onto the run so far, restarting from its leading free bits
+    size_t runStart = 0;
+    size_t runLength = 0;
+    while (i < usedWords) {
+        uint64_t w = bits[i];
+        if (runLength == 0) {
+            runStart = i * 64;
+        }
+        if (w == ~uint64_t(0)) {
+            runLength += 64;
+            if (runLength >= n) {
+                return runStart;
+            }
+            ++i;
+            continue;
+        }
+        if (runLength + __builtin_ctzll(~w) >= n) {
+            return runStart;
+        }
+        runLength = __builtin_clzll(~w);
+        runStart = (i + 1) * 64 - runLength;
+        i = runLength != 0 ? i + 1 : skipAllocated(bits, i + 1, usedWords);
+    }
+    return NO_RUN;
+}
+
+void BitmapPool::markRange(size_t first, size_t count, bool free) {
+    for (size_t word = first / 64; word <= (first + count - 1) / 64; ++word) {
+        uint64_t mask = wordMask(word, first, count);
+        if (free) {
+            words[word] |= mask;
+        } else {
+            words[word] &= ~mask;
+        }
+    }
+}
+
+BitmapPoolStats BitmapPool::getStats() {
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    BitmapPoolStats stats = { freeBlockCount, 0, 0, 0.0 };
+    size_t runLength = 0;
+    uint64_t carry = 0;             // Top bit of the previous word
+    for (size_t i = 0; i < usedWords; ++i) {
+        uint64_t w = words[i];
+        stats.freeRuns += __builtin_popcountll(w & ~((w << 1) | carry));
+        carry = w >> 63;
+        if (w == ~uint64_t(0)) {
+            runLength += 64;
+            continue;
+        }
+        runLength += __builtin_ctzll(~w);
+        stats.largestFreeRun = std::max(stats.largestFreeRun, std::max(runLength, longestRun(w)));
+        runLength = __builtin_clzll(~w);
+    }
+    stats.largestFreeRun = std::max(stats.largestFreeRun, runLength);
+    if (stats.freeBlocks != 0) {
+        stats.fragmentation = 1.0 - static_cast<double>(stats.largestFreeRun) / stats.freeBlocks;
+    }
+    return stats;
+}
@@ -0,0 +1,75 @@
+#ifndef BITMAP_POOL_H
+#define BITMAP_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct BitmapPoolStats {
+    size_t freeBlocks;
+    size_t largestFreeRun;          // Longest run allocateContiguous() could serve now
+    size_t freeRuns;                // Maximal runs of free blocks
+    double fragmentation;           // 1 - largestFreeRun / freeBlocks (0 when empty or whole)
+};
+
+// Fixed-size pool that tracks free blocks in a bitmap instead of a free
+// list, so it can hand out runs of adjacent blocks.
+//
+// allocateContiguous(n) returns n blocks laid out back to back, for small
+// arrays of pooled objects that should share cache lines or be loaded with
+// SIMD. The search skips fully allocated words 128 or 256 bits at a time
+// with SSE2/AVX2 compares, then finds a run of n free bits with shift-and
+// folding over two words (n <= 64) or run counting across words (n > 64).
+// A hint keeps the scan from revisiting the allocated prefix. Allocation
+// is first-fit from the lowest address, which keeps runs long.
+//
+//   BitmapPool pool(64, 4096);
+//   Descriptor* d = static_cast<Descriptor*>(pool.allocateContiguous(4));
+//   pool.deallocateContiguous(d, 4);
+class BitmapPool {
+public:
+    BitmapPool(size_t blockSize, size_t numBlocks, bool threadSafe = false);
+    ~BitmapPool();
+
+    BitmapPool(const BitmapPool&) = delete;
+    BitmapPool& operator=(const BitmapPool&) = delete;
+
+    void* allocate() { return allocateContiguous(1); }
+    void deallocate(void* ptr) { deallocateContiguous(ptr, 1); }
+
+    // n adjacent blocks, or nullptr if no free run is long enough
+    void* allocateContiguous(size_t n);
+
+    // n must match the allocation. In MEMPOOL_SAFE_MODE, foreign pointers
+    // and blocks already free throw std::invalid_argument.
+    void deallocateContiguous(void* ptr, size_t n);
+
+    // Walks the whole bitmap under the lock
+    BitmapPoolStats getStats();
+
+    inline size_t getFreeBlocks() const { return freeBlockCount; }
+    inline size_t getBlockSize() const { return blockSize; }
+    inline size_t getTotalBlocks() const { return totalBlocks; }
+
+private:
+    char* memoryStart;
+    size_t blockSize;
+    size_t totalBlocks;
+    size_t freeBlockCount;
+    size_t mappedBytes;
+    bool threadSafe;
+    std::mutex poolMutex;
+
+    // Bit set = block free. Bits past totalBlocks stay clear, and four zero
+    // words follow the last used one, so the vector skip and the two-word
+    // window never read past the end.
+    std::vector<uint64_t> words;
+    size_t usedWords;               // Words that cover blocks
+    size_t firstFreeWord;           // No free bit below this word
+
+    size_t findRun(size_t n);
+    void markRange(size_t first, size_t count, bool free);
+};
+
+#endif // BITMAP_POOL_H
@@ -0,0 +1,14 @@
+#ifndef BLOCK_LINKER_H
+#define BLOCK_LINKER_H
+
+#include <cstddef>
+
+// Free-list construction shared by MemoryPool and the small-object
+// allocator's spans. Links count blocks starting at start in address order,
+// the last one pointing at tail. blockSize must be a multiple of 16.
+// start may have any alignment: ranges over 32 MB use streaming stores as
+// wide as start's alignment allows (16, 32 or 64 bytes), and fall back to
+// plain stores when start is not 16-byte aligned.
+void linkBlocks(char* start, size_t blockSize, size_t count, void* tail);
+
+#endif // BLOCK_LINKER_H
@@ -0,0 +1,144 @@
+#ifndef CPU_CACHE_H
+#define CPU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define CPU_CACHE_RSEQ 1
+// Exported by glibc 2.35+, which registers rseq for every thread it starts.
+// Weak, so older C libraries link and report rseq as unavailable.
+extern "C" {
+extern const ptrdiff_t __rseq_offset __attribute__((weak));
+extern const unsigned int __rseq_size __attribute__((weak));
+}
+#endif
+
+// A stack of free blocks. The critical sections below index slabs by CPU
+// with a shift, so the size is fixed at 2 KB.
+struct CacheSlab {
+    uint64_t count;
+    void* slots[255];
+};
+
+static_assert(sizeof(CacheSlab) == 2048, "CpuCache indexes slabs with a shift by 11");
+
+// Per-CPU slab operations on Linux restartable sequences (rseq).
+//
+// slabs points at one CacheSlab per possible CPU. push() and pop() read the
+// current CPU from the thread's rseq area and update that CPU's slab with
+// ordinary loads and stores; the final store of count commits. If the
+// thread is preempted, migrated or signalled before the commit, the kernel
+// restarts the sequence, so no lock or atomic instruction is needed.
+class CpuCache {
+public:
+    static const size_t MAX_BLOCKS = 255;
+
+    // True if the C library registered rseq for the calling thread
+    static bool available() {
+#ifdef CPU_CACHE_RSEQ
+        if (&__rseq_size == nullptr || __rseq_size == 0) {
+            return false;
+        }
+        int32_t cpu;
+        asm volatile("movl %%fs:4(%1), %0" : "=r"(cpu) : "r"(__rseq_offset));
+        return cpu >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // false if this CPU's slab already holds capacity blocks
+    static inline bool push(CacheSlab* slabs, size_t capacity, void* block) {
+#ifdef CPU_CACHE_RSEQ
+        // 3: critical-section descriptor, 1..2: the sequence, 4: abort
+        // handler preceded by the signature glibc registered (RSEQ_SIG)
+    retry:
+        asm goto(
+            ".pushsection __rseq_cs, \"aw\"\n\t"
+            ".balign 32\n\t"
+            "3:\n\t"
+            ".long 0x0, 0x0\n\t"
+            ".quad 1f, (2f - 1f), 4f\n\t"
+            ".popsection\n\t"
+            "leaq 3b(%%rip), %%rax\n\t"
+            "movq %%rax, %%fs:8(%[rseq])\n\t"
+            "1:\n\t"
+            "movl %%fs:4(%[rseq]), %%eax\n\t"
+            "shlq $11, %%rax\n\t"
+            "addq %[slabs], %%rax\n\t"
+            "movq (%%rax), %%rcx\n\t"
+            "cmpq %[capacity], %%rcx\n\t"
+            "jae %l[full]\n\t"
+            "movq %[block], 8(%%rax, %%rcx, 8)\n\t"
+            "incq %%rcx\n\t"
+            "movq %%rcx, (%%rax)\n\t"
+            "2:\n\t"
+            ".pushsection __rseq_failure, \"ax\"\n\t"
+            ".byte 0x0f, 0xb9, 0x3d\n\t"
+            ".long 0x53053053\n\t"
+            "4:\n\t"
+            "jmp %l[retry]\n\t"
+            ".popsection\n\t"
+            :
+            : [rseq] "r"(__rseq_offset), [slabs] "r"(slabs), [capacity] "r"(capacity), [block] "r"(block)
+            : "rax", "rcx", "memory", "cc"
+            : full, retry);
+        return true;
+    full:
+        return false;
+#else
+        (void)slabs;
+        (void)capacity;
+        (void)block;
+        return false;
+#endif
+    }
+
+    // nullptr if this CPU's slab is empty
+    static inline void* pop(CacheSlab* slabs) {
+#ifdef CPU_CACHE_RSEQ
+        void* block;
+    retry:
+        asm goto(
+            ".pushsection __rseq_cs, \"aw\"\n\t"
+            ".balign 32\n\t"
+            "3:\n\t"
+            ".long 0x0, 0x0\n\t"
+            ".quad 1f, (2f - 1f), 4f\n\t"
+            ".popsection\n\t"
+            "leaq 3b(%%rip), %%rax\n\t"
+            "movq %%rax, %%fs:8(%[rseq])\n\t"
+            "1:\n\t"
+            "movl %%fs:4(%[rseq]), %%eax\n\t"
+            "shlq $11, %%rax\n\t"
+            "addq %[slabs], %%rax\n\t"
+            "movq (%%rax), %%rcx\n\t"
+            "testq %%rcx, %%rcx\n\t"
+            "jz %l[empty]\n\t"
+            "movq (%%rax, %%rcx, 8), %%rdx\n\t"
+            "movq %%rdx, (%[out])\n\t"
+            "decq %%rcx\n\t"
+            "movq %%rcx, (%%rax)\n\t"
+            "2:\n\t"
+            ".pushsection __rseq_failure, \"ax\"\n\t"
+            ".byte 0x0f, 0xb9, 0x3d\n\t"
+            ".long 0x53053053\n\t"
+            "4:\n\t"
+            "jmp %l[retry]\n\t"
+            ".popsection\n\t"
+            :
+            : [rseq] "r"(__rseq_offset), [slabs] "r"(slabs), [out] "r"(&block)
+            : "rax", "rcx", "rdx", "memory", "cc"
+            : empty, retry);
+        return block;
+    empty:
+        return nullptr;
+#else
+        (void)slabs;
+        return nullptr;
+#endif
+    }
+};
+
+#endif // CPU_CACHE_H
@@ -0,0 +1,170 @@
+#include "DelegatedAllocator.h"
+#include "MemoryPool.h"
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+
+// Passes with nothing to do before the allocator thread yields its CPU
+static const int IDLE_SPINS = 1024;
+
+// A client waiting on its rings spins this long, then lets the allocator
+// thread run in case they share a CPU
+static const int CLIENT_SPINS = 256;
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+DelegatedAllocator::Client::Client(DelegatedAllocator& owner, size_t ringSize)
+    : owner(owner)
+    , ready(ringSize)
+    , returned(ringSize)
+    , emptyAsks(0)
+    , emptyAnswered(0) {
+}
+
+void* DelegatedAllocator::Client::operator new(size_t size) {
+    void* memory;
+    if (posix_memalign(&memory, 64, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void DelegatedAllocator::Client::operator delete(void* ptr) {
+    std::free(ptr);
+}
+
+void* DelegatedAllocator::Client::allocate() {
+    void* block;
+    if (ready.pop(block)) {
+        return block;
+    }
+    // Ask the allocator thread to confirm the pool is empty. Only an answer
+    // to this ask counts, so an empty pool seen earlier, or while serving
+    // another client, never fails this call.
+    size_t ask = emptyAsks.fetch_add(1, std::memory_order_acq_rel) + 1;
+    int spins = 0;
+    while (!ready.pop(block)) {
+        if (emptyAnswered.load(std::memory_order_acquire) >= ask) {
+            return ready.pop(block) ? block : nullptr;
+        }
+        if (++spins < CLIENT_SPINS) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return block;
+}
+
+void DelegatedAllocator::Client::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    int spins = 0;
+    while (!returned.push(ptr)) {
+        if (++spins < CLIENT_SPINS) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+DelegatedAllocator::DelegatedAllocator(MemoryPool& pool, size_t ringSize, int cpu)
+    : pool(pool)
+    , ringSize(ringSize)
+    , clientCount(0)
+    , stopping(false) {
+    if (ringSize == 0) {
+        throw std::invalid_argument("Ring size must be greater than 0");
+    }
+    server = std::thread(&DelegatedAllocator::serve, this);
+    if (cpu >= 0) {
+        cpu_set_t target;
+        CPU_ZERO(&target);
+        CPU_SET(cpu, &target);
+        pthread_setaffinity_np(server.native_handle(), sizeof(target), &target);
+    }
+}
+
+DelegatedAllocator::~DelegatedAllocator() {
+    stopping.store(true, std::memory_order_release);
+    server.join();
+
+    // Both sides of every ring belong to this thread now
+    size_t count = clientCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        void* block;
+        while (clients[i]->returned.pop(block)) {
+            pool.deallocate(block);
+        }
+        while (clients[i]->ready.pop(block)) {
+            pool.deallocate(block);
+        }
+        delete clients[i];
+    }
+}
+
+DelegatedAllocator::Client& DelegatedAllocator::registerClient() {
+    std::lock_guard<std::mutex> lock(registerMutex);
+    size_t count = clientCount.load(std::memory_order_relaxed);
+    if (count == MAX_CLIENTS) {
+        throw std::length_error("DelegatedAllocator: more than MAX_CLIENTS clients");
+    }
+    // Published before the count, which the allocator thread reads first
+    clients[count] = new Client(*this, ringSize);
+    clientCount.store(count + 1, std::memory_order_release);
+    return *clients[count];
+}
+
+void DelegatedAllocator::serve() {
+    int idle = 0;
+    while (!stopping.load(std::memory_order_acquire)) {
+        bool busy = false;
+        size_t count = clientCount.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            busy |= serveClient(*clients[i]);
+        }
+        if (busy) {
+            idle = 0;
+        } else if (++idle < IDLE_SPINS) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Returned blocks go straight back into the client's ready ring; only the
+// surplus or the shortfall touches the pool. Returns true if anything moved.
+bool DelegatedAllocator::serveClient(Client& client) {
+    // Read first: an answer covers only asks made before this pass
+    size_t ask = client.emptyAsks.load(std::memory_order_acquire);
+    bool moved = false;
+    void* block;
+    while (client.returned.pop(block)) {
+        if (!client.ready.push(block)) {
+            pool.deallocate(block);
+        }
+        moved = true;
+    }
+    while (client.ready.size() < client.ready.capacity()) {
+        block = pool.allocate();
+        if (!block) {
+            // The client may fail only if nothing is left for it to pop
+            if (client.ready.size() == 0 && client.emptyAnswered.load(std::memory_order_relaxed) < ask) {
+                client.emptyAnswered.store(ask, std::memory_order_release);
+            }
+            return moved;
+        }
+        client.ready.push(block);
+        moved = true;
+    }
+    return moved;
+}
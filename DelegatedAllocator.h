@@ -0,0 +1,85 @@
+#ifndef DELEGATED_ALLOCATOR_H
+#define DELEGATED_ALLOCATOR_H
+
+#include "SpscRing.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+class MemoryPool;
+
+// Moves all of a pool's bookkeeping onto one allocator thread.
+//
+// Each client thread gets a pair of SPSC rings: one the allocator keeps
+// filled with ready blocks, one the client pushes freed blocks into. A
+// client allocate() is a ring pop and a deallocate() a ring push, so the
+// client never touches the free list, a lock or a line another client
+// writes. The allocator thread recycles returned blocks into the ready
+// ring they came back on and trades the surplus with the pool. The pool
+// is used only by that thread, so it need not be thread-safe.
+//
+//   DelegatedAllocator delegated(pool);
+//   DelegatedAllocator::Client& client = delegated.registerClient();
+//   void* p = client.allocate();            // on the client thread
+//   client.deallocate(p);
+class DelegatedAllocator {
+public:
+    static const size_t MAX_CLIENTS = 64;
+
+    class Client {
+    public:
+        // Waits while the ready ring is empty; nullptr once the allocator
+        // thread has found both this ring and the pool empty after the call
+        // started
+        void* allocate();
+
+        // Waits while the return ring is full
+        void deallocate(void* ptr);
+
+    private:
+        friend class DelegatedAllocator;
+        Client(DelegatedAllocator& owner, size_t ringSize);
+
+        // The rings' cache-line alignment, which plain new ignores before C++17
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr);
+
+        DelegatedAllocator& owner;
+        SpscRing<void*> ready;          // Allocator thread -> client
+        SpscRing<void*> returned;       // Client -> allocator thread
+        std::atomic<size_t> emptyAsks;      // Allocations that found the ring empty
+        std::atomic<size_t> emptyAnswered;  // Last ask answered with "pool empty"
+    };
+
+    // ringSize blocks are kept ready per client. cpu >= 0 pins the
+    // allocator thread to that CPU.
+    explicit DelegatedAllocator(MemoryPool& pool, size_t ringSize = 64, int cpu = -1);
+
+    // Stops the allocator thread and returns every ringed block to the
+    // pool; clients must be done with their rings
+    ~DelegatedAllocator();
+
+    DelegatedAllocator(const DelegatedAllocator&) = delete;
+    DelegatedAllocator& operator=(const DelegatedAllocator&) = delete;
+
+    // Rings for one client thread; valid until the allocator is destroyed.
+    // Throws std::length_error past MAX_CLIENTS.
+    Client& registerClient();
+
+    size_t getClientCount() const { return clientCount.load(std::memory_order_acquire); }
+
+private:
+    MemoryPool& pool;
+    size_t ringSize;
+    Client* clients[MAX_CLIENTS];
+    std::atomic<size_t> clientCount;
+    std::mutex registerMutex;               // Serializes registerClient()
+    std::atomic<bool> stopping;
+    std::thread server;
+
+    void serve();
+    bool serveClient(Client& client);
+};
+
+#endif // DELEGATED_ALLOCATOR_H
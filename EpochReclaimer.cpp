@@ -0,0 +1,154 @@
+#include "EpochReclaimer.h"
+#include "MemoryPool.h"
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Process-wide thread indices, shared by every reclaimer. An index is
+// recycled when its thread exits; guards are scoped, so by then the
+// thread's slot is inactive in every reclaimer.
+std::mutex& indexMutex() {
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+std::vector<size_t>& freeIndices() {
+    static std::vector<size_t>* indices = new std::vector<size_t>();
+    return *indices;
+}
+
+size_t nextIndex = 0;
+
+// Plain data, so the common path needs no TLS initialization check
+thread_local size_t threadIndex = EpochReclaimer::MAX_THREADS;
+
+struct ThreadIndexOwner {
+    bool assigned = false;
+    ~ThreadIndexOwner() {
+        if (assigned) {
+            std::lock_guard<std::mutex> lock(indexMutex());
+            freeIndices().push_back(threadIndex);
+            threadIndex = EpochReclaimer::MAX_THREADS;
+        }
+    }
+};
+
+thread_local ThreadIndexOwner threadIndexOwner;
+
+size_t currentThreadIndex() {
+    if (threadIndex < EpochReclaimer::MAX_THREADS) {
+        return threadIndex;
+    }
+    std::lock_guard<std::mutex> lock(indexMutex());
+    if (!freeIndices().empty()) {
+        threadIndex = freeIndices().back();
+        freeIndices().pop_back();
+    } else if (nextIndex < EpochReclaimer::MAX_THREADS) {
+        threadIndex = nextIndex++;
+    } else {
+        throw std::runtime_error("EpochReclaimer: more than MAX_THREADS threads");
+    }
+    threadIndexOwner.assigned = true;
+    return threadIndex;
+}
+
+} // namespace
+
+EpochReclaimer::EpochReclaimer(MemoryPool& pool, size_t collectThreshold, size_t maxPending)
+    : pool(pool)
+    , globalEpoch(1)
+    , slots(MAX_THREADS)
+    , pending(0)
+    , collectThreshold(collectThreshold > 0 ? collectThreshold : 1)
+    , maxPending(maxPending) {
+    for (ReaderSlot& slot : slots) {
+        slot.epoch.store(0, std::memory_order_relaxed);
+        slot.depth = 0;
+    }
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    for (std::vector<void*>& bag : limbo) {
+        pool.deallocateBatch(bag.data(), bag.size());
+    }
+}
+
+EpochReclaimer::Guard::Guard(EpochReclaimer& reclaimer)
+    : reclaimer(reclaimer) {
+    reclaimer.enter();
+}
+
+EpochReclaimer::Guard::~Guard() {
+    reclaimer.exit();
+}
+
+void EpochReclaimer::enter() {
+    ReaderSlot& slot = slots[currentThreadIndex()];
+    if (slot.depth++ == 0) {
+        // The seq_cst store orders the pin before every read that follows
+        slot.epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    }
+}
+
+void EpochReclaimer::exit() {
+    ReaderSlot& slot = slots[threadIndex];
+    if (--slot.depth == 0) {
+        slot.epoch.store(0, std::memory_order_release);
+    }
+}
+
+bool EpochReclaimer::tryAdvance() {
+    uint64_t epoch = globalEpoch.load();
+    for (const ReaderSlot& slot : slots) {
+        uint64_t seen = slot.epoch.load();
+        if (seen != 0 && seen != epoch) {
+            return false;
+        }
+    }
+    globalEpoch.store(epoch + 1);
+
+    // Blocks retired in epoch - 1 are now two epochs old
+    std::vector<void*>& bag = limbo[(epoch + 2) % 3];
+    pool.deallocateBatch(bag.data(), bag.size());
+    pending -= bag.size();
+    bag.clear();
+    return true;
+}
+
+void EpochReclaimer::retire(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(retireMutex);
+    limbo[globalEpoch.load() % 3].push_back(ptr);
+    if (++pending % collectThreshold == 0) {
+        tryAdvance();
+    }
+
+    bool pinned = threadIndex < MAX_THREADS && slots[threadIndex].depth > 0;
+    while (maxPending && pending > maxPending && !pinned) {
+        if (!tryAdvance()) {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
+}
+
+size_t EpochReclaimer::collect() {
+    std::lock_guard<std::mutex> lock(retireMutex);
+    size_t before = pending;
+    // Two advances make everything retired so far safe
+    for (int i = 0; i < 2; ++i) {
+        if (!tryAdvance()) {
+            break;
+        }
+    }
+    return before - pending;
+}
+
+size_t EpochReclaimer::getPendingBlocks() {
+    std::lock_guard<std::mutex> lock(retireMutex);
+    return pending;
+}
@@ -0,0 +1,87 @@
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class MemoryPool;
+
+// Epoch-based deferred reclamation for pool blocks read without locks.
+//
+// Readers wrap every access to shared blocks in a Guard. A writer that
+// unlinks a block calls retire() instead of deallocate(); the block goes
+// back to the pool once every reader that could still see it has left its
+// guard. The global epoch advances only when all active readers have
+// observed the current one, so a block retired in epoch e is safe from
+// epoch e + 2 on. Safe blocks return to the pool in one deallocateBatch().
+//
+//   EpochReclaimer reclaimer(pool);
+//   {   EpochReclaimer::Guard guard(reclaimer);
+//       Node* node = head.load(); ...               // reader
+//   }
+//   Node* old = head.exchange(fresh);               // writer
+//   reclaimer.retire(old);
+class EpochReclaimer {
+public:
+    static const size_t MAX_THREADS = 256;      // Threads alive at once
+
+    // Every collectThreshold retirements try to advance the epoch. Past
+    // maxPending retired blocks, retire() waits for readers instead of
+    // growing the backlog (0 = unbounded).
+    explicit EpochReclaimer(MemoryPool& pool, size_t collectThreshold = 64, size_t maxPending = 4096);
+
+    // Returns every retired block to the pool; no guard may be held
+    ~EpochReclaimer();
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    // Pins the current epoch for the calling thread; guards may nest
+    class Guard {
+    public:
+        explicit Guard(EpochReclaimer& reclaimer);
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochReclaimer& reclaimer;
+    };
+
+    // Defer deallocate(ptr) until no reader can hold ptr. A thread inside a
+    // Guard never waits on maxPending, since it would wait on itself.
+    void retire(void* ptr);
+
+    // Advance the epoch as far as readers allow; returns blocks freed
+    size_t collect();
+
+    size_t getPendingBlocks();
+    uint64_t getEpoch() const { return globalEpoch.load(); }
+
+private:
+    // One per thread index, 64 bytes apart so readers do not share lines
+    struct ReaderSlot {
+        std::atomic<uint64_t> epoch;        // 0 while not reading
+        uint64_t depth;                     // Nested guards, owner thread only
+        char padding[48];
+    };
+
+    MemoryPool& pool;
+    std::atomic<uint64_t> globalEpoch;
+    std::vector<ReaderSlot> slots;
+
+    std::mutex retireMutex;                 // Guards everything below
+    std::vector<void*> limbo[3];            // Retired blocks by epoch % 3
+    size_t pending;
+    size_t collectThreshold;
+    size_t maxPending;
+
+    void enter();
+    void exit();
+    bool tryAdvance();                      // retireMutex held
+};
+
+#endif // EPOCH_RECLAIMER_H
@@ -0,0 +1,247 @@
+#include "HeapProfiler.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <execinfo.h>
+
+// recordAllocation() itself is dropped from every trace. Pool frames below
+// it are kept: with tail calls their depth varies by build.
+static const int SKIP_FRAMES = 1;
+static const int MAX_FRAMES = 64;
+
+namespace {
+
+struct StackStats {
+    size_t liveCount;
+    size_t liveBytes;
+    size_t allocCount;
+    size_t allocBytes;
+};
+
+struct Sample {
+    size_t bytes;
+    size_t stack;               // Index into ProfileState::stacks
+};
+
+struct ProfileState {
+    std::mutex mutex;
+    std::atomic<size_t> sampleInterval{512 * 1024};
+    std::map<std::vector<void*>, size_t> stackIndex;
+    std::vector<const std::vector<void*>*> stacks;
+    std::vector<StackStats> stats;
+    std::unordered_map<const void*, Sample> live;
+};
+
+ProfileState& state() {
+    // Leaked on purpose: pools may free sampled blocks during static destruction
+    static ProfileState* profile = new ProfileState();
+    return *profile;
+}
+
+// Per-thread Poisson countdown, so sampling needs no shared writes
+thread_local int64_t bytesUntilSample = 0;
+thread_local bool countdownStarted = false;
+thread_local uint64_t rngState = 0;
+
+// Exponentially distributed distance to the next sample, mean = interval
+int64_t nextSampleDistance(size_t interval) {
+    if (rngState == 0) {
+        rngState = reinterpret_cast<uintptr_t>(&rngState) ^ 0x9E3779B97F4A7C15ull;
+    }
+    // xorshift64*: top 53 bits as a uniform double in (0, 1]
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    uint64_t bits = (rngState * 0x2545F4914F6CDD1Dull) >> 11;
+    double uniform = (bits + 1.0) / 9007199254740992.0;
+    return static_cast<int64_t>(-std::log(uniform) * interval) + 1;
+}
+
+// Expected number of real allocations one sample of this size stands for
+double unsampleScale(size_t bytes, size_t interval) {
+    double probability = 1.0 - std::exp(-static_cast<double>(bytes) / interval);
+    return probability > 0.0 ? 1.0 / probability : 1.0;
+}
+
+// "binary(function+0x1c) [0x...]" -> "function", falling back to the address
+std::string frameName(const char* symbol, void* address) {
+    const char* open = std::strchr(symbol, '(');
+    const char* plus = open ? std::strchr(open, '+') : nullptr;
+    if (open && plus && plus > open + 1) {
+        return std::string(open + 1, plus);
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+}
+
+} // namespace
+
+std::atomic<bool> HeapProfiler::active(false);
+
+void HeapProfiler::start(size_t sampleIntervalBytes) {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    profile.sampleInterval.store(sampleIntervalBytes > 0 ? sampleIntervalBytes : 1, std::memory_order_relaxed);
+    active.store(true, std::memory_order_relaxed);
+}
+
+void HeapProfiler::stop() {
+    active.store(false, std::memory_order_relaxed);
+}
+
+bool HeapProfiler::shouldSample(size_t bytes) {
+    size_t interval = state().sampleInterval.load(std::memory_order_relaxed);
+    if (!countdownStarted) {
+        countdownStarted = true;
+        bytesUntilSample = nextSampleDistance(interval);
+    }
+    bytesUntilSample -= static_cast<int64_t>(bytes);
+    if (bytesUntilSample > 0) {
+        return false;
+    }
+    bytesUntilSample = nextSampleDistance(interval);
+    return true;
+}
+
+void HeapProfiler::recordAllocation(const void* ptr, size_t bytes) {
+    // Unwind outside the lock; backtrace() is the expensive part
+    void* frames[MAX_FRAMES];
+    int depth = backtrace(frames, MAX_FRAMES);
+    int skip = depth > SKIP_FRAMES ? SKIP_FRAMES : 0;
+    std::vector<void*> stack(frames + skip, frames + depth);
+
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    auto inserted = profile.stackIndex.insert(std::make_pair(stack, profile.stacks.size()));
+    if (inserted.second) {
+        profile.stacks.push_back(&inserted.first->first);
+        StackStats empty = { 0, 0, 0, 0 };
+        profile.stats.push_back(empty);
+    }
+    size_t index = inserted.first->second;
+    StackStats& stats = profile.stats[index];
+    ++stats.liveCount;
+    stats.liveBytes += bytes;
+    ++stats.allocCount;
+    stats.allocBytes += bytes;
+
+    Sample sample = { bytes, index };
+    profile.live[ptr] = sample;
+}
+
+bool HeapProfiler::recordDeallocation(const void* ptr) {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    auto found = profile.live.find(ptr);
+    if (found == profile.live.end()) {
+        return false;
+    }
+    StackStats& stats = profile.stats[found->second.stack];
+    --stats.liveCount;
+    stats.liveBytes -= found->second.bytes;
+    profile.live.erase(found);
+    return true;
+}
+
+void HeapProfiler::writeHeapProfile(std::ostream& out) {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+
+    StackStats total = { 0, 0, 0, 0 };
+    for (const StackStats& stats : profile.stats) {
+        total.liveCount += stats.liveCount;
+        total.liveBytes += stats.liveBytes;
+        total.allocCount += stats.allocCount;
+        total.allocBytes += stats.allocBytes;
+    }
+
+    // Counts are raw samples; pprof unsamples heap_v2 using the period
+    out << "heap profile: " << total.liveCount << ": " << total.liveBytes
+        << " [" << total.allocCount << ": " << total.allocBytes << "] @ heap_v2/"
+        << profile.sampleInterval.load() << "\n";
+    for (size_t i = 0; i < profile.stacks.size(); ++i) {
+        const StackStats& stats = profile.stats[i];
+        out << stats.liveCount << ": " << stats.liveBytes
+            << " [" << stats.allocCount << ": " << stats.allocBytes << "] @";
+        for (void* frame : *profile.stacks[i]) {
+            out << " " << frame;
+        }
+        out << "\n";
+    }
+
+    // pprof needs the mappings to symbolize addresses
+    out << "\nMAPPED_LIBRARIES:\n";
+    std::ifstream maps("/proc/self/maps");
+    out << maps.rdbuf();
+}
+
+void HeapProfiler::writeFoldedStacks(std::ostream& out) {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+
+    for (size_t i = 0; i < profile.stacks.size(); ++i) {
+        const StackStats& stats = profile.stats[i];
+        if (stats.liveCount == 0) {
+            continue;
+        }
+        const std::vector<void*>& stack = *profile.stacks[i];
+        char** symbols = backtrace_symbols(stack.data(), static_cast<int>(stack.size()));
+
+        // Folded format runs from the root frame to the leaf
+        for (size_t frame = stack.size(); frame-- > 0;) {
+            out << (symbols ? frameName(symbols[frame], stack[frame]) : frameName("", stack[frame]));
+            out << (frame > 0 ? ";" : " ");
+        }
+        size_t blockBytes = stats.liveBytes / stats.liveCount;
+        double estimate = stats.liveBytes * unsampleScale(blockBytes, profile.sampleInterval.load());
+        out << static_cast<size_t>(estimate) << "\n";
+        std::free(symbols);
+    }
+}
+
+size_t HeapProfiler::recordRangeFreed(const void* begin, const void* end) {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    const char* low = static_cast<const char*>(begin);
+    const char* high = static_cast<const char*>(end);
+    size_t removed = 0;
+    for (auto it = profile.live.begin(); it != profile.live.end();) {
+        const char* ptr = static_cast<const char*>(it->first);
+        if (ptr >= low && ptr < high) {
+            StackStats& stats = profile.stats[it->second.stack];
+            --stats.liveCount;
+            stats.liveBytes -= it->second.bytes;
+            it = profile.live.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+size_t HeapProfiler::getLiveBytes() {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    double estimate = 0.0;
+    for (const auto& entry : profile.live) {
+        estimate += entry.second.bytes * unsampleScale(entry.second.bytes, profile.sampleInterval.load());
+    }
+    return static_cast<size_t>(estimate);
+}
+
+size_t HeapProfiler::getLiveSamples() {
+    ProfileState& profile = state();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    return profile.live.size();
+}
@@ -0,0 +1,54 @@
+#ifndef HEAP_PROFILER_H
+#define HEAP_PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+
+// Process-wide sampling heap profiler for pooled allocations.
+//
+// Allocations are sampled with a Poisson process over bytes: on average one
+// sample every sampleInterval bytes, each sample capturing a stack trace.
+// Sampled blocks stay in a live table until freed, so a profile shows both
+// what is in use now and what was allocated since start().
+//
+// Pools check isActive() once per allocation; when the profiler is off that
+// relaxed load is the whole cost.
+class HeapProfiler {
+public:
+    // Begin sampling, roughly one sample per sampleIntervalBytes allocated
+    static void start(size_t sampleIntervalBytes = 512 * 1024);
+
+    // Stop taking new samples. Live samples are still retired as they are
+    // freed, so profiles written after stop() remain accurate.
+    static void stop();
+
+    static inline bool isActive() {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // Hooks for pool front-ends. shouldSample() consumes bytes from the
+    // calling thread's countdown; only call recordAllocation() when it fires.
+    static bool shouldSample(size_t bytes);
+    static void recordAllocation(const void* ptr, size_t bytes);
+    static bool recordDeallocation(const void* ptr);   // true if ptr was sampled
+
+    // Retire every sample in [begin, end), for pool reset() and destruction
+    static size_t recordRangeFreed(const void* begin, const void* end);
+
+    // Legacy gperftools heap profile ("heap_v2"), readable by pprof:
+    //   pprof --text ./binary heap.prof
+    static void writeHeapProfile(std::ostream& out);
+
+    // Folded stacks weighted by estimated live bytes, for flamegraph.pl
+    static void writeFoldedStacks(std::ostream& out);
+
+    // Estimated live bytes and sampled live block count
+    static size_t getLiveBytes();
+    static size_t getLiveSamples();
+
+private:
+    static std::atomic<bool> active;
+};
+
+#endif // HEAP_PROFILER_H
@@ -1,8 +1,142 @@
 #ifndef MEMORY_POOL_H
 #define MEMORY_POOL_H
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class MemoryPool;
+class AsyncAllocator;
+struct PoolSnapshot;
+struct CacheSlab;
+
+// Where a pool may park free blocks outside its locked free list
+enum class PoolCache {
+    None,
+    PerThread,                      // One slab per thread using the pool
+    PerCpu                          // One slab per CPU, via rseq; PerThread if unavailable
+};
+
+// Who is asking for a block; see PoolOptions::highPriorityReserve
+enum class Priority {
+    Low,                            // Refused once only the reserve is left
+    High                            // May take the reserve
+};
+
+// Optional pool behaviour. Everything is off by default, so a
+// default-constructed PoolOptions gives the plain fast pool.
+struct PoolOptions {
+    bool threadSafe = false;        // Guard the pool with a mutex
+    std::string name;               // Non-empty: list the pool in PoolRegistry
+
+    // Quarantine: freed blocks are poisoned and parked in a FIFO before they
+    // go back on the free list, so a use-after-free hits a poisoned block
+    // instead of someone else's live data. Capacity is the larger of the two.
+    // Only the first 64 bytes of a block are poisoned and checked, so a free
+    // costs the same for any block size; quarantinePoisonAll covers it whole.
+    size_t quarantineBlocks = 0;
+    size_t quarantineBytes = 0;
+    bool quarantinePoisonAll = false;
+
+    // Leak tracking: remember the call site (return address or user tag) of
+    // live blocks so leaks can be reported by site. Sampling tracks only
+    // 1 in leakSampleRate allocations to keep the side table small.
+    bool trackLeaks = false;
+    size_t leakSampleRate = 1;
+
+    // Residency: prefault populates every page at construction
+    // (MAP_POPULATE + MADV_WILLNEED) and lockMemory pins them with mlock, so
+    // no allocation pays for a page fault. trim() keeps such pools resident.
+    bool prefault = false;
+    bool lockMemory = false;        // Throws std::system_error if mlock fails
+
+    // Zeroing: trackZeroed keeps a bit per block that is set while the block
+    // is known to be zero apart from its free-list link (fresh mmap pages,
+    // pages returned by trim()), so allocateZeroed() can skip the memset.
+    // zeroOnReset makes reset() zero the pool, with non-temporal stores for
+    // large pools, so every block is known-zero again afterwards.
+    bool trackZeroed = false;
+    bool zeroOnReset = false;
+
+    // Occupancy: keep a live-block count per page, so takeSnapshot() only
+    // copies the counts under the lock. Its pause then depends on the
+    // pool's size rather than on how many blocks are free, at the cost of a
+    // counter update per allocation and free. Cannot be combined with
+    // lockFree (throws std::invalid_argument).
+    bool trackOccupancy = false;
+
+    // Threads used to build the free list in the constructor and reset().
+    // Each links (and, with prefault, populates) its own page-aligned slice,
+    // so pages land on that thread's NUMA node. Slices are at least 8 MB.
+    size_t initThreads = 1;
+
+    // Block caches: stacks of free blocks in front of the free list, so most
+    // allocate()/deallocate() calls take no lock. Per-CPU slabs bound the
+    // parked memory by the CPU count instead of the thread count. Implies
+    // threadSafe; cannot be combined with the quarantine, leak tracking or
+    // trackZeroed (throws std::invalid_argument). Cached blocks count as used.
+    PoolCache cache = PoolCache::None;
+    size_t cacheBlocks = 32;        // Blocks per slab, 1 to 255
+
+    // Lock-free mode: the free list is a Treiber stack updated by CAS, its
+    // head packing the top block's offset with an ABA tag. With
+    // eliminationSlots > 0, a deallocate() whose CAS failed offers its block
+    // in a random slot for a moment, and an allocate() whose CAS failed
+    // takes it, so the pair never touches the head. Cannot be combined with
+    // the quarantine, leak tracking, trackZeroed or caches; trim() is a
+    // no-op and takeSnapshot() needs the pool quiescent.
+    bool lockFree = false;
+    size_t eliminationSlots = 0;
+
+    // Flat combining: allocate() and deallocate() publish their request in
+    // a slot, and whichever thread gets the pool mutex serves every pending
+    // slot in one pass while the free list stays in its cache. Implies
+    // threadSafe; cannot be combined with lockFree or caches.
+    bool flatCombining = false;
+
+    // Soft watermark in used blocks (0 = off; tunable as "soft_watermark").
+    // onPressure runs each time usage rises to it, on the allocating thread
+    // after the pool lock is released, so it may free blocks to this pool.
+    // The pool's mapping also counts towards MemoryPressure's process total.
+    size_t softWatermark = 0;
+    std::function<void(MemoryPool&)> onPressure;
+
+    // Free blocks kept for allocate(Priority::High) (tunable as
+    // "high_priority_reserve"). Every other allocation fails once only
+    // this many are left on the free list; blocks parked in caches are not
+    // part of the reserve. Checked against the free count the pool already
+    // keeps, so it costs no extra lock. Cannot be combined with lockFree.
+    size_t highPriorityReserve = 0;
+};
+
+struct QuarantineStats {
+    size_t capacity;                // Blocks the quarantine can hold
+    size_t held;                    // Blocks currently waiting in quarantine
+    size_t released;                // Blocks recycled back to the free list
+    size_t corruptions;             // Blocks written to while quarantined
+};
+
+struct CacheStats {
+    PoolCache mode;                 // PerCpu falls back to PerThread without rseq
+    size_t slabs;                   // Slabs in use, 2 KB each
+    size_t cachedBlocks;            // Free blocks parked in slabs
+};
+
+// Leaked blocks grouped by the site that allocated them
+struct LeakSite {
+    const void* site;               // Return address, or the tag string
+    bool tagged;                    // site is a const char* from allocateTagged()
+    size_t blocks;                  // Tracked blocks still live
+    size_t bytes;                   // blocks * block size
+};
 
 class MemoryPool {
 private:
@@ -13,19 +147,162 @@ private:
     void* memoryStart;          // Start of memory pool
     Block* freeList;            // Head of free list
     size_t blockSize;           // Size of each block (aligned)
+    size_t requestedSize;       // Block size asked for, before alignment
     size_t totalBlocks;         // Total number of blocks
     size_t freeBlockCount;      // Number of free blocks
+    size_t mappedBytes;         // Size of the mmap'd region (page multiple)
     bool threadSafe;            // Thread safety flag
+    bool registered;            // Listed in PoolRegistry
+    bool keepResident;          // Prefaulted or locked: trim() keeps pages
+    bool zeroOnReset;           // reset() clears block contents
+    size_t initThreads;         // Threads building the free list
     std::mutex poolMutex;       // Mutex for thread safety
 
+    // Free blocks whose pages trim() returned to the OS, as [first, last)
+    // index runs. They count as free but are off the free list until refilled.
+    std::vector<std::pair<size_t, size_t>> releasedRuns;
+
+    // One bit per block, set while the block is known-zero (empty when
+    // trackZeroed is off)
+    std::vector<uint64_t> zeroBits;
+
+    // Live blocks starting in each page (empty when trackOccupancy is off)
+    std::vector<uint16_t> pageLive;
+
+    // Where a paused takeSnapshot() resumes its free-list walk. Reset to
+    // nullptr when that block is popped or the list is rebuilt, which sends
+    // the walk back to the head. Only one snapshot walks at a time.
+    Block* snapshotCursor;
+    std::mutex snapshotMutex;
+
+    // Quarantine ring (empty when the quarantine is disabled)
+    std::vector<Block*> quarantine;
+    size_t quarantineHead;      // Index of the oldest quarantined block
+    size_t quarantineCount;     // Blocks currently quarantined
+    size_t quarantineReleased;  // Blocks recycled out of quarantine
+    size_t quarantineCorruptions; // Poison mismatches seen on release
+    size_t poisonBytes;         // Leading bytes of a block poisoned and checked
+
+    // Leak tracking side table: live block -> allocation site
+    struct AllocationSite {
+        const void* id;
+        bool tagged;
+    };
+    bool leakTracking;          // Side table enabled
+    size_t leakSampleRate;      // Track 1 in N allocations
+    size_t leakSampleCountdown; // Allocations until the next tracked one
+    std::unordered_map<void*, AllocationSite> liveSites;
+
+    // Block caches (cacheMode None when disabled)
+    PoolCache cacheMode;
+    std::atomic<size_t> cacheBlocks;    // Capacity of each slab
+    uint64_t poolId;                    // Thread slabs key on this; never reused
+    CacheSlab* cpuSlabs;                // One per possible CPU
+    size_t cpuSlabCount;
+    std::vector<CacheSlab*> threadSlabList; // Slabs of live threads
+    struct ThreadSlabs;
+    static thread_local ThreadSlabs threadSlabs;
+
+    // Lock-free mode: head is tag << headOffsetBits | (offset / 16 + 1),
+    // with a zero offset field when empty
+    struct EliminationSlot {
+        std::atomic<uintptr_t> value;       // 0 empty, 1 taken, else an offered block
+        std::atomic<size_t> exchanges;      // Pairs completed through this slot
+        char padding[48];
+    };
+    bool lockFree;
+    std::atomic<uint64_t> lockFreeHead;
+    int headOffsetBits;                     // Just enough for the pool, at most 32
+    uint64_t headOffsetMask;
+    std::vector<EliminationSlot> elimination;
+
+    // Flat combining: a request slot per publishing thread, served under poolMutex
+    struct CombiningSlot {
+        std::atomic<uint32_t> state;        // Free, claimed, pending or done
+        bool isFree;                        // deallocate() rather than allocate()
+        void* block;                        // Block to free, or the block allocated
+        char padding[48];
+    };
+    bool flatCombining;
+    std::vector<CombiningSlot> combining;
+    std::atomic<size_t> combiningUsed;      // Slots ever published, a prefix bound
+    std::atomic<size_t> combiningPending;   // Published and not yet served (may run ahead)
+
+    // allocateWait() sleepers wait on a futex word bumped on every wakeup.
+    // Their count lives in slowPath; an AsyncAllocator with queued requests
+    // counts as one more, and frees serve it before any sleeper.
+    std::atomic<uint32_t> freeEvents;
+    std::atomic<AsyncAllocator*> asyncAllocator;
+    friend class AsyncAllocator;
+
+    // Soft watermark: pressureFree is the free count at the watermark
+    // (SIZE_MAX when off); the allocation reaching it raises the flag and
+    // the allocating call runs onPressure once it holds no lock. Atomic
+    // because lock-free allocations read it while setTunable() writes it.
+    std::atomic<size_t> pressureFree;
+    std::atomic<bool> pressureRaised;
+    std::function<void(MemoryPool&)> onPressure;
+
+    size_t highReserve;         // Free blocks only Priority::High may take
+
+    // Zero for a plain pool, so allocate() and deallocate() test one word
+    // before taking the bare free-list path. The low byte holds a bit per
+    // enabled option, bits 16-31 count allocateWait() sleepers and bits
+    // 32-63 count blocks sampled by HeapProfiler.
+    std::atomic<uint64_t> slowPath;
+
+    // One bit per block, set while HeapProfiler holds a sample of it, so a
+    // free only takes the profiler's lock for a sampled block. Allocated on
+    // the first sample; words are accessed with __atomic builtins.
+    std::atomic<uint64_t*> sampledBits;
+
     // Helper functions
     static size_t alignSize(size_t size, size_t alignment = alignof(std::max_align_t));
-    void* allocateInternal();
+    void* allocateInternal(bool* knownZero = nullptr, bool high = false);
     void deallocateInternal(void* ptr);
+    void* popFree();
+    void pushFree(void* ptr);
+    void* allocateSlow(const void* site);
+    void deallocateSlow(void* ptr);
+    void setSlowBit(uint64_t bit, bool on);
+    void addWaiter();
+    void removeWaiter();
+    bool hasWaiters(std::memory_order order = std::memory_order_seq_cst) const;
+    bool markSample(void* ptr);
+    void retireSample(void* ptr);
+    bool takeZeroBit(void* ptr);
+    void countLive(void* ptr, bool live);
+    void resetInternal();
+    void* allocateTracked(const void* site, bool tagged, bool* knownZero = nullptr, bool high = false);
+    void quarantinePush(Block* block);
+    Block* quarantinePop();
+    void drainQuarantine();
+    void refillFromReleased();
+    CacheSlab* threadSlab();
+    CacheSlab* findThreadSlab();
+    void releaseThreadSlab(CacheSlab* slab);
+    bool pushCache(void* block);
+    void* popCache();
+    void* refillCache();
+    void flushCache(void* block);
+    size_t cachedBlockCount();
+    void* popLockFree();
+    void pushLockFree(Block* block);
+    void setLockFreeHead(Block* first);
+    bool offerBlock(Block* block);
+    void* takeOfferedBlock();
+    void* combine(bool isFree, void* block);
+    void serveCombining();
+    void wakeWaiters(int count);
+    bool serveAsync();
+    void setWatermark(size_t usedBlocks);
+    void notePressure(size_t freeBlocks);
+    void firePressure();
 
 public:
     // Constructor
     MemoryPool(size_t blockSize, size_t numBlocks, bool threadSafe = false);
+    MemoryPool(size_t blockSize, size_t numBlocks, const PoolOptions& options);
     
     // Destructor
     ~MemoryPool();
@@ -37,18 +314,93 @@ public:
     // Allocate a block from the pool
     void* allocate();
 
+    // Priority::High may also take the highPriorityReserve blocks, so it
+    // only fails when the pool is truly exhausted; Priority::Low behaves
+    // like allocate()
+    void* allocate(Priority priority);
+
+    // Allocate a block, sleeping until another thread frees one if the pool
+    // is exhausted. Returns nullptr if none came free within timeout. Only
+    // blocks that reach the shared free list wake sleepers; with caches,
+    // blocks parked in other threads' slabs do not.
+    void* allocateWait(std::chrono::nanoseconds timeout);
+
+    // Allocate a block with all bytes zero (calloc-style). With trackZeroed,
+    // blocks still fresh from the OS only have their link word cleared.
+    void* allocateZeroed();
+
+    // Allocate and, when leak tracking is on, attribute the block to tag
+    // instead of the caller's return address. tag must outlive the pool.
+    void* allocateTagged(const char* tag);
+
     // Deallocate a block back to the pool
     void deallocate(void* ptr);
 
+    // Deallocate count blocks under a single lock acquisition
+    void deallocateBatch(void* const* blocks, size_t count);
+
     // Reset the pool (frees all allocations)
     void reset();
 
+    // Flush the quarantine and return pages holding only free blocks to the
+    // OS. Those blocks stay free and are relinked on demand when the free
+    // list runs dry. Returns the bytes released (always 0 for pools built
+    // with prefault or lockMemory).
+    size_t trim();
+
+    // Change a runtime setting by name: "quarantine_blocks",
+    // "leak_sample_rate", "init_threads", "cache_blocks",
+    // "soft_watermark" or "high_priority_reserve". Returns false for
+    // unknown keys, bad values and settings that would have no effect on
+    // this pool (a quarantine on cached or lock-free pools or above
+    // totalBlocks, a sample rate without trackLeaks).
+    bool setTunable(const std::string& key, size_t value);
+
     // Query functions
     inline bool isExhausted() const { return freeBlockCount == 0; }
     inline size_t getUsedBlocks() const { return totalBlocks - freeBlockCount; }
     inline size_t getFreeBlocks() const { return freeBlockCount; }
     inline size_t getBlockSize() const { return blockSize; }
     inline size_t getTotalBlocks() const { return totalBlocks; }
+    inline size_t getHighPriorityReserve() const { return highReserve; }
+
+    // Whether other threads may call into the pool: it has a lock, or it
+    // is lock-free
+    inline bool isThreadSafe() const { return threadSafe || lockFree; }
+
+    // getUsedBlocks() read under the lock (atomically in lock-free mode),
+    // for monitoring a thread-safe pool from another thread
+    size_t sampleUsedBlocks();
+
+    // Whether ptr lies inside this pool's blocks; one range test
+    inline bool owns(const void* ptr) const {
+        const char* address = static_cast<const char*>(ptr);
+        const char* start = static_cast<const char*>(memoryStart);
+        return address >= start && address < start + blockSize * totalBlocks;
+    }
+
+    // Allocate/deallocate pairs exchanged through the elimination array
+    size_t getEliminatedPairs() const;
+
+    // Slabs and parked blocks (all zero when caching is off)
+    CacheStats getCacheStats();
+
+    // Quarantine counters (all zero when the quarantine is disabled)
+    QuarantineStats getQuarantineStats();
+
+    // Live tracked blocks grouped by allocation site, largest first.
+    // Empty unless the pool was built with trackLeaks.
+    std::vector<LeakSite> collectLeaks();
+
+    // Write collectLeaks() in human-readable form (also done by the destructor)
+    void reportLeaks(std::ostream& out);
+
+    // Per-page occupancy map. With trackOccupancy the lock is held only to
+    // copy the per-page counts; otherwise the free list is walked into a
+    // preallocated bitmap a bounded batch at a time, dropping the lock in
+    // between, so blocks allocated or freed during the walk may show either
+    // state. Neither allocates or does I/O under the lock.
+    PoolSnapshot takeSnapshot();
 };
 
 #endif // MEMORY_POOL_H
\ No newline at end of file
@@ -1,18 +1,470 @@
 #include "MemoryPool.h"
+#include "AsyncAllocator.h"
+#include "BlockLinker.h"
+#include "CpuCache.h"
+#include "HeapProfiler.h"
+#include "MemoryPressure.h"
+#include "PoolRegistry.h"
+#include "PoolSnapshot.h"
 #include <cstdlib>
 #include <iostream>
 #include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <unordered_set>
+#include <climits>
+#include <new>
+#include <execinfo.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 // OPTIMIZED VERSION - Removes tracking overhead for maximum performance
 // Trade-off: No double-free detection, minimal safety checks
 
+// Byte pattern written over quarantined blocks
+static const unsigned char QUARANTINE_POISON = 0xDF;
+
+// Bytes at the start of a quarantined block that are poisoned, unless the
+// pool asks for whole blocks. A stale pointer is most often used through
+// its first fields, and one line keeps the cost of a free flat.
+static const size_t QUARANTINE_PREFIX_BYTES = 64;
+
+// Released blocks are relinked at most this many bytes at a time, so an
+// allocation after trim() faults in a bounded number of pages
+static const size_t REFILL_BYTES = 64 * 1024;
+
+// reset() with zeroOnReset switches to non-temporal stores above this size,
+// where the pool would otherwise flush most of the cache
+static const size_t STREAM_ZERO_BYTES = 1024 * 1024;
+
+// Plain linking switches to streaming stores above this size, where the
+// pool would not stay cached anyway and skipping line reads halves traffic
+static const size_t STREAM_LINK_BYTES = 32 * 1024 * 1024;
+
+// Smallest slice worth a thread when initializing in parallel
+static const size_t PARALLEL_INIT_BYTES = 8 * 1024 * 1024;
+
+// Free blocks takeSnapshot() marks per lock hold, and how often its walk may
+// be sent back to the head before it finishes under one hold
+static const size_t SNAPSHOT_BATCH_BLOCKS = 4096;
+static const size_t SNAPSHOT_MAX_RESTARTS = 4;
+
+// slowPath layout. Options fixed at construction share one bit; those
+// that can be tuned at runtime have their own.
+static const uint64_t SLOW_OPTIONS = 1;     // Leak tracking, trackZeroed, caches, lockFree or combining
+static const uint64_t SLOW_QUARANTINE = 2;
+static const uint64_t SLOW_WATERMARK = 4;
+static const uint64_t SLOW_RESERVE = 8;
+static const uint64_t SLOW_WAITER = uint64_t(1) << 16;
+static const uint64_t SLOW_WAITER_MASK = uint64_t(0xFFFF) << 16;
+static const uint64_t SLOW_SAMPLE = uint64_t(1) << 32;
+static const uint64_t SLOW_SAMPLE_MASK = ~uint64_t(0) << 32;
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+static size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// Fault in a page-aligned range from the calling thread. Kernels before 5.14
+// lack MADV_POPULATE_WRITE; touching a word with an atomic no-op instead is
+// safe while other threads are writing links into the same pages.
+static void populatePages(char* begin, size_t bytes) {
+    if (madvise(begin, bytes, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+    for (size_t offset = 0; offset < bytes; offset += pageSize()) {
+        __atomic_fetch_or(reinterpret_cast<uint64_t*>(begin + offset), 0, __ATOMIC_RELAXED);
+    }
+}
+
+#if defined(__SSE2__)
+// Link count blocks with non-temporal stores, writing the first headBytes
+// of each block: the link word followed by zeros. headBytes is a multiple
+// of 16, at most blockSize. Whole cache lines are written,
+// so the CPU never reads the old contents in, and the pool does not evict
+// the working set from cache. start must be 16-byte aligned; the wider
+// stores fault on unaligned addresses, so they are used only when start
+// is aligned to their width.
+static void streamLinks(char* start, size_t blockSize, size_t count, void* tail, size_t headBytes) {
+    for (size_t i = 0; i < count; ++i) {
+        char* block = start + i * blockSize;
+        long long next = reinterpret_cast<long long>(i + 1 < count ? block + blockSize : tail);
+#if defined(__AVX512F__)
+        if (headBytes % 64 == 0 && reinterpret_cast<uintptr_t>(start) % 64 == 0) {
+            _mm512_stream_si512(reinterpret_cast<__m512i*>(block), _mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, next));
+            for (size_t offset = 64; offset < headBytes; offset += 64) {
+                _mm512_stream_si512(reinterpret_cast<__m512i*>(block + offset), _mm512_setzero_si512());
+            }
+            continue;
+        }
+#endif
+#if defined(__AVX2__)
+        if (headBytes % 32 == 0 && reinterpret_cast<uintptr_t>(start) % 32 == 0) {
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(block), _mm256_set_epi64x(0, 0, 0, next));
+            for (size_t offset = 32; offset < headBytes; offset += 32) {
+                _mm256_stream_si256(reinterpret_cast<__m256i*>(block + offset), _mm256_setzero_si256());
+            }
+            continue;
+        }
+#endif
+        // Blocks stay 16-byte aligned: blockSize is a multiple of 16
+        _mm_stream_si128(reinterpret_cast<__m128i*>(block), _mm_set_epi64x(0, next));
+        for (size_t offset = 16; offset < headBytes; offset += 16) {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(block + offset), _mm_setzero_si128());
+        }
+    }
+    _mm_sfence();
+}
+#endif
+
+// Link count blocks starting at start in address order, the last one
+// pointing at tail. Every link is computed from its index rather than
+// read back from the previous block, so there is no store-to-load chain
+// and small blocks take several links per vector store. Ranges too big
+// for the cache are written with streaming stores instead.
+void linkBlocks(char* start, size_t blockSize, size_t count, void* tail) {
+    if (count == 0) {
+        return;
+    }
+#if defined(__SSE2__)
+    if (blockSize * count >= STREAM_LINK_BYTES && reinterpret_cast<uintptr_t>(start) % 16 == 0) {
+        // Blocks on cache-line multiples only need their first line written;
+        // smaller or odd sizes are written whole so every line is complete
+        streamLinks(start, blockSize, count, tail, blockSize % 64 == 0 ? 64 : blockSize);
+        return;
+    }
+#endif
+    size_t i = 0;
+#if defined(__AVX512F__)
+    // 16-byte blocks: four links per store; 32-byte blocks: two
+    if (blockSize == 16 || blockSize == 32) {
+        long long base = reinterpret_cast<long long>(start);
+        long long size = static_cast<long long>(blockSize);
+        size_t perStore = 64 / blockSize;
+        __m512i next = (blockSize == 16)
+            ? _mm512_set_epi64(0, base + 4 * size, 0, base + 3 * size, 0, base + 2 * size, 0, base + size)
+            : _mm512_set_epi64(0, 0, 0, base + 2 * size, 0, 0, 0, base + size);
+        __m512i step = (blockSize == 16)
+            ? _mm512_set_epi64(0, 64, 0, 64, 0, 64, 0, 64)
+            : _mm512_set_epi64(0, 0, 0, 64, 0, 0, 0, 64);
+        for (; i + perStore < count; i += perStore) {
+            _mm512_storeu_si512(reinterpret_cast<void*>(start + i * blockSize), next);
+            next = _mm512_add_epi64(next, step);
+        }
+    }
+#elif defined(__AVX2__)
+    // 16-byte blocks: two links per store
+    if (blockSize == 16) {
+        long long base = reinterpret_cast<long long>(start);
+        __m256i next = _mm256_set_epi64x(0, base + 32, 0, base + 16);
+        __m256i step = _mm256_set_epi64x(0, 32, 0, 32);
+        for (; i + 2 < count; i += 2) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(start + i * blockSize), next);
+            next = _mm256_add_epi64(next, step);
+        }
+    }
+#endif
+    for (; i + 1 < count; ++i) {
+        *reinterpret_cast<void**>(start + i * blockSize) = start + (i + 1) * blockSize;
+    }
+    *reinterpret_cast<void**>(start + (count - 1) * blockSize) = tail;
+}
+
+// Zero blocks and link each to the next in one pass. Large pools use
+// streaming stores so the reset does not pull the pool through the cache.
+static void zeroAndLink(char* start, size_t blockSize, size_t numBlocks, void* tail) {
+    if (numBlocks == 0) {
+        return;
+    }
+#if defined(__SSE2__)
+    if (blockSize * numBlocks >= STREAM_ZERO_BYTES && reinterpret_cast<uintptr_t>(start) % 16 == 0) {
+        streamLinks(start, blockSize, numBlocks, tail, blockSize);
+        return;
+    }
+#endif
+    std::memset(start, 0, blockSize * numBlocks);
+    linkBlocks(start, blockSize, numBlocks, tail);
+}
+
+// Pin a helper thread to one of the CPUs we may run on, spreading helpers
+// evenly so that on multi-socket machines each touches its own node
+static void pinToSpreadCpu(std::thread& thread, size_t worker, size_t workers) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.size() < 2) {
+        return;
+    }
+    cpu_set_t target;
+    CPU_ZERO(&target);
+    CPU_SET(cpus[worker * cpus.size() / workers], &target);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(target), &target);
+}
+
+// Build the whole free list in address order, optionally zeroing blocks and
+// populating pages first. With several threads the pool is cut into
+// page-aligned slices; each thread populates its pages (so first-touch
+// places them on its NUMA node) and links the blocks that start in them,
+// its last block pointing at the next slice's first block.
+static void buildFreeList(char* start, size_t blockSize, size_t numBlocks, size_t threads,
+                          bool zero, bool populate) {
+    size_t pages = (blockSize * numBlocks + pageSize() - 1) / pageSize();
+    size_t maxThreads = pages / (PARALLEL_INIT_BYTES / pageSize());
+    if (threads > maxThreads) {
+        threads = maxThreads > 0 ? maxThreads : 1;
+    }
+
+    auto slice = [=](size_t worker) {
+        size_t firstPage = worker * pages / threads;
+        size_t lastPage = (worker + 1) * pages / threads;
+        if (populate) {
+            populatePages(start + firstPage * pageSize(), (lastPage - firstPage) * pageSize());
+        }
+        size_t first = (firstPage * pageSize() + blockSize - 1) / blockSize;
+        size_t last = std::min(numBlocks, (lastPage * pageSize() + blockSize - 1) / blockSize);
+        if (first >= last) {
+            return;
+        }
+        void* tail = last < numBlocks ? start + last * blockSize : nullptr;
+        if (zero) {
+            zeroAndLink(start + first * blockSize, blockSize, last - first, tail);
+        } else {
+            linkBlocks(start + first * blockSize, blockSize, last - first, tail);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (size_t worker = 1; worker < threads; ++worker) {
+        helpers.emplace_back(slice, worker);
+        pinToSpreadCpu(helpers.back(), worker, threads);
+    }
+    slice(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+}
+
+// Blocks moved between a slab and the free list at a time
+static size_t cacheBatch(size_t capacity) {
+    return capacity > 1 ? capacity / 2 : 1;
+}
+
+// Pools with per-thread slabs, by id. Exiting threads only hand their
+// blocks back to pools still listed here. Never destroyed, since threads
+// can exit after static destructors have run.
+static std::mutex& cachePoolsMutex() {
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+static std::unordered_set<uint64_t>& liveCachePools() {
+    static std::unordered_set<uint64_t>* pools = new std::unordered_set<uint64_t>();
+    return *pools;
+}
+
+static std::atomic<uint64_t> nextPoolId(1);
+
+// Last slab used by this thread. Plain data, so the hit path needs no TLS
+// initialization check.
+static thread_local uint64_t lastSlabPool = 0;
+static thread_local CacheSlab* lastSlab = nullptr;
+
+// Lock-free head: the top block's offset in 16-byte units plus one in the
+// low headOffsetBits, sized to the pool, and a tag bumped by every update
+// in the rest. The offset may take at most 32 bits (64 GB), so the tag
+// wraps only after 2^32 or more updates: an ABA needs a thread stalled
+// between its load and its CAS for exactly a multiple of that many.
+static const int MAX_HEAD_OFFSET_BITS = 32;
+
+// Elimination slot states; anything else is an offered block
+static const uintptr_t SLOT_EMPTY = 0;
+static const uintptr_t SLOT_TAKEN = 1;
+
+// How long a deallocate() waits in a slot for a partner
+static const int ELIMINATION_SPINS = 128;
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Per-thread xorshift state for picking slots; plain data, seeded lazily
+static thread_local uint32_t eliminationSeed = 0;
+
+static size_t randomSlot(size_t slots) {
+    uint32_t x = eliminationSeed;
+    if (x == 0) {
+        x = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&eliminationSeed) >> 4) | 1;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    eliminationSeed = x;
+    return x % slots;
+}
+
+// Flat-combining slots per pool, and their states
+static const size_t COMBINING_SLOTS = 64;
+static const uint32_t COMBINE_FREE = 0;
+static const uint32_t COMBINE_CLAIMED = 1;
+static const uint32_t COMBINE_PENDING = 2;
+static const uint32_t COMBINE_DONE = 3;
+
+// Waiters spin this long before yielding the CPU to the combiner. On a
+// single CPU the combiner cannot run while they spin, so they yield at once.
+static const int COMBINE_SPINS = 256;
+
+static int combineSpins() {
+    static const int spins = std::thread::hardware_concurrency() > 1 ? COMBINE_SPINS : 0;
+    return spins;
+}
+
+// Preferred slot of this thread; threads get spread round-robin
+static std::atomic<uint32_t> nextCombiningSlot(0);
+static thread_local uint32_t combiningSlot = UINT32_MAX;
+
+// Sleep while *word == expected, for at most timeout; spurious returns are fine
+static void futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) {
+    timespec relative;
+    relative.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    relative.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &relative, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+struct ThreadSlabEntry {
+    MemoryPool* pool;
+    uint64_t poolId;
+    CacheSlab* slab;
+};
+
+// Owns the calling thread's slabs and returns their blocks when it exits
+struct MemoryPool::ThreadSlabs {
+    std::vector<ThreadSlabEntry> entries;
+
+    ~ThreadSlabs() {
+        std::lock_guard<std::mutex> lock(cachePoolsMutex());
+        for (const ThreadSlabEntry& entry : entries) {
+            if (liveCachePools().count(entry.poolId)) {
+                entry.pool->releaseThreadSlab(entry.slab);
+            }
+            delete entry.slab;
+        }
+        entries.clear();
+        lastSlabPool = 0;
+        lastSlab = nullptr;
+    }
+};
+
+thread_local MemoryPool::ThreadSlabs MemoryPool::threadSlabs;
+
+// Unmaps a range, and returns its MemoryPressure reservation if it holds
+// one, unless dismissed. A constructor that throws after mapping leaks
+// neither; its destructor does not run.
+class MappingGuard {
+public:
+    MappingGuard(void* start, size_t bytes, bool reserved)
+        : start(start), bytes(bytes), reserved(reserved) {
+        if (reserved) {
+            MemoryPressure::reserve(bytes, false);
+        }
+    }
+    ~MappingGuard() {
+        if (start) {
+            munmap(start, bytes);
+            if (reserved) {
+                MemoryPressure::release(bytes, false);
+            }
+        }
+    }
+    void dismiss() { start = nullptr; }
+
+private:
+    void* start;
+    size_t bytes;
+    bool reserved;
+};
+
+static PoolOptions makeOptions(bool threadSafe) {
+    PoolOptions options;
+    options.threadSafe = threadSafe;
+    return options;
+}
+
 MemoryPool::MemoryPool(size_t blockSize, size_t numBlocks, bool threadSafe)
+    : MemoryPool(blockSize, numBlocks, makeOptions(threadSafe)) {
+}
+
+MemoryPool::MemoryPool(size_t blockSize, size_t numBlocks, const PoolOptions& options)
     : memoryStart(nullptr)              
     , freeList(nullptr)                 
     , blockSize(alignSize(blockSize))   
+    , requestedSize(blockSize)
     , totalBlocks(numBlocks)            
     , freeBlockCount(numBlocks)         
-    , threadSafe(threadSafe) {          
+    , mappedBytes(0)
+    , threadSafe(options.threadSafe)
+    , registered(false)
+    , keepResident(options.prefault || options.lockMemory)
+    , zeroOnReset(options.zeroOnReset)
+    , initThreads(options.initThreads > 0 ? options.initThreads : 1)
+    , snapshotCursor(nullptr)
+    , quarantineHead(0)
+    , quarantineCount(0)
+    , quarantineReleased(0)
+    , quarantineCorruptions(0)
+    , poisonBytes(options.quarantinePoisonAll ? this->blockSize
+                  : std::min(this->blockSize, QUARANTINE_PREFIX_BYTES))
+    , leakTracking(options.trackLeaks)
+    , leakSampleRate(options.leakSampleRate > 0 ? options.leakSampleRate : 1)
+    , leakSampleCountdown(1)
+    , cacheMode(options.cache)
+    , cacheBlocks(options.cacheBlocks)
+    , poolId(0)
+    , cpuSlabs(nullptr)
+    , cpuSlabCount(0)
+    , lockFree(options.lockFree)
+    , lockFreeHead(0)
+    , headOffsetBits(0)
+    , headOffsetMask(0)
+    , flatCombining(options.flatCombining)
+    , combiningUsed(0)
+    , combiningPending(0)
+    , freeEvents(0)
+    , asyncAllocator(nullptr)
+    , pressureFree(SIZE_MAX)
+    , pressureRaised(false)
+    , onPressure(options.onPressure)
+    , highReserve(options.highPriorityReserve)
+    , slowPath(0)
+    , sampledBits(nullptr) {
     
     if (blockSize < sizeof(Block*)) {
         this->blockSize = alignSize(sizeof(Block*));
@@ -21,62 +473,502 @@ MemoryPool::MemoryPool(size_t blockSize, size_t numBlocks, bool threadSafe)
     if (numBlocks == 0) {
         throw std::invalid_argument("Number of blocks must be greater than 0");
     }
+    if (cacheMode != PoolCache::None) {
+        // Those features need every free and allocation to pass the lock
+        if (options.quarantineBlocks || options.quarantineBytes || options.trackLeaks || options.trackZeroed) {
+            throw std::invalid_argument("Block caches cannot be combined with quarantine, leak tracking or trackZeroed");
+        }
+        if (options.cacheBlocks == 0 || options.cacheBlocks > CpuCache::MAX_BLOCKS) {
+            throw std::invalid_argument("cacheBlocks must be between 1 and 255");
+        }
+        threadSafe = true;
+    }
+    if (lockFree) {
+        if (options.quarantineBlocks || options.quarantineBytes || options.trackLeaks
+            || options.trackZeroed || options.trackOccupancy || cacheMode != PoolCache::None) {
+            throw std::invalid_argument("Lock-free mode cannot be combined with quarantine, leak tracking, trackZeroed, trackOccupancy or caches");
+        }
+        // Largest offset + 1 is (numBlocks - 1) * blockSize / 16 + 1 <= bytes / 16
+        headOffsetBits = 64 - __builtin_clzll((this->blockSize * numBlocks) / 16);
+        if (headOffsetBits > MAX_HEAD_OFFSET_BITS) {
+            throw std::invalid_argument("Lock-free pools are limited to 64 GB");
+        }
+        headOffsetMask = (uint64_t(1) << headOffsetBits) - 1;
+        // The head replaces the mutex; every other path is quiescent-only
+        threadSafe = false;
+        elimination = std::vector<EliminationSlot>(options.eliminationSlots);
+    }
+    if (flatCombining) {
+        if (lockFree || cacheMode != PoolCache::None) {
+            throw std::invalid_argument("Flat combining cannot be combined with lockFree or caches");
+        }
+        threadSafe = true;
+        combining = std::vector<CombiningSlot>(COMBINING_SLOTS);
+    }
+    if (highReserve > 0 && (lockFree || highReserve >= numBlocks)) {
+        throw std::invalid_argument("highPriorityReserve must be below numBlocks and cannot be combined with lockFree");
+    }
+    if (leakTracking || options.trackZeroed || options.trackOccupancy || cacheMode != PoolCache::None || lockFree || flatCombining) {
+        setSlowBit(SLOW_OPTIONS, true);
+    }
+    setSlowBit(SLOW_RESERVE, highReserve > 0);
+
+    // Allocate one contiguous chunk of memory. Pages come straight from mmap
+    // so trim() can hand whole free pages back to the OS.
+    mappedBytes = (this->blockSize * numBlocks + pageSize() - 1) & ~(pageSize() - 1);
+
+    // Side tables are sized before mapping, so if one throws there is
+    // nothing to undo
 
-    // Allocate one contiguous chunk of memory
-    memoryStart = std::malloc(this->blockSize * numBlocks);
-    if (!memoryStart) {
+    // Quarantine sized in blocks; a byte budget is rounded up to whole blocks
+    size_t quarantineCapacity = options.quarantineBlocks;
+    size_t byteCapacity = (options.quarantineBytes + this->blockSize - 1) / this->blockSize;
+    if (byteCapacity > quarantineCapacity) {
+        quarantineCapacity = byteCapacity;
+    }
+    if (quarantineCapacity > 0) {
+        quarantine.resize(quarantineCapacity);
+        setSlowBit(SLOW_QUARANTINE, true);
+    }
+
+    // Fresh anonymous pages are zero; only the link words will be written
+    if (options.trackZeroed) {
+        zeroBits.assign((numBlocks + 63) / 64, ~uint64_t(0));
+    }
+    if (options.trackOccupancy) {
+        pageLive.assign(mappedBytes / pageSize(), 0);
+    }
+
+    // A parallel build populates its own slices instead of MAP_POPULATE,
+    // which would fault every page from this thread
+    bool populateInSlices = options.prefault && initThreads > 1;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (options.prefault && !populateInSlices) {
+        flags |= MAP_POPULATE;
+    }
+    memoryStart = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (memoryStart == MAP_FAILED) {
+        memoryStart = nullptr;
         throw std::bad_alloc();
     }
+    // Parallel init threads, mlock and the cache setup below can still throw
+    MappingGuard mapping(memoryStart, mappedBytes, true);
+    if (options.prefault && !populateInSlices) {
+        madvise(memoryStart, mappedBytes, MADV_WILLNEED);
+    }
     
     // Initialize free list by linking all blocks
+    buildFreeList(static_cast<char*>(memoryStart), this->blockSize, numBlocks, initThreads,
+                  false, populateInSlices);
     freeList = static_cast<Block*>(memoryStart);
-    Block* current = freeList;
-    
-    for (size_t i = 0; i < numBlocks - 1; ++i) {
-        // Calculate next block address
-        void* nextAddr = static_cast<char*>(static_cast<void*>(current)) + this->blockSize;
-        current->next = static_cast<Block*>(nextAddr);
-        current = current->next;
+    setLockFreeHead(freeList);
+
+    if (options.lockMemory && mlock(memoryStart, mappedBytes) != 0) {
+        throw std::system_error(errno, std::generic_category(), "mlock of pool memory failed");
+    }
+
+    // Slabs for every possible CPU; pages of CPUs never used stay untouched
+    if (cacheMode == PoolCache::PerCpu && !CpuCache::available()) {
+        cacheMode = PoolCache::PerThread;
+    }
+    if (cacheMode == PoolCache::PerCpu) {
+        cpuSlabCount = static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF));
+        void* slabs = mmap(nullptr, cpuSlabCount * sizeof(CacheSlab), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slabs == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        cpuSlabs = static_cast<CacheSlab*>(slabs);
+    }
+    MappingGuard slabMapping(cpuSlabs, cpuSlabCount * sizeof(CacheSlab), false);
+    if (cacheMode == PoolCache::PerThread) {
+        poolId = nextPoolId.fetch_add(1);
+        std::lock_guard<std::mutex> lock(cachePoolsMutex());
+        liveCachePools().insert(poolId);
+    }
+
+    setWatermark(options.softWatermark);
+    mapping.dismiss();
+    slabMapping.dismiss();
+
+    // Register last, once the pool is fully usable; add() does not allocate
+    if (!options.name.empty()) {
+        registered = PoolRegistry::add(this, options.name);
     }
-    current->next = nullptr;  // Last block points to null
 }
 
 MemoryPool::~MemoryPool() {
+    if (registered) {
+        PoolRegistry::remove(this);
+    }
+
+    // Threads exiting from now on keep their slabs to themselves
+    size_t cached = 0;
+    if (cacheMode == PoolCache::PerThread) {
+        std::lock_guard<std::mutex> lock(cachePoolsMutex());
+        liveCachePools().erase(poolId);
+        cached = cachedBlockCount();
+    } else if (cacheMode == PoolCache::PerCpu) {
+        cached = cachedBlockCount();
+        munmap(cpuSlabs, cpuSlabCount * sizeof(CacheSlab));
+    }
+
     // Simple check for leaks
-    if (freeBlockCount != totalBlocks) {
+    if (freeBlockCount + cached != totalBlocks) {
         std::cerr << "WARNING: Memory leak detected! "
-                  << (totalBlocks - freeBlockCount) << " blocks not freed.\n";
+                  << (totalBlocks - freeBlockCount - cached) << " blocks not freed.\n";
+        if (leakTracking) {
+            reportLeaks(std::cerr);
+        }
     }
     
+    if ((slowPath.load(std::memory_order_relaxed) & SLOW_SAMPLE_MASK) != 0) {
+        HeapProfiler::recordRangeFreed(memoryStart, static_cast<char*>(memoryStart) + blockSize * totalBlocks);
+    }
+    delete[] sampledBits.load(std::memory_order_relaxed);
+
     // Free the entire memory pool
     if (memoryStart) {
-        std::free(memoryStart);
+        munmap(memoryStart, mappedBytes);
+        MemoryPressure::release(mappedBytes, false);
     }
 }
 
 void* MemoryPool::allocate() {
+    // Every option, sleeper and profiler sample shows up in slowPath, so a
+    // plain pool pays one test before the bare pop
+    if (__builtin_expect((slowPath.load(std::memory_order_relaxed) | HeapProfiler::isActive()) != 0, 0)) {
+        return allocateSlow(__builtin_return_address(0));
+    }
     if (threadSafe) {
         std::lock_guard<std::mutex> lock(poolMutex);
+        return popFree();
+    }
+    return popFree();
+}
+
+void* MemoryPool::allocateSlow(const void* site) {
+    void* block;
+    if (leakTracking || HeapProfiler::isActive()) {
+        block = allocateTracked(site, false);
+    } else if (cacheMode != PoolCache::None) {
+        block = popCache();
+        if (!block) {
+            block = refillCache();
+        }
+    } else if (flatCombining) {
+        block = combine(false, nullptr);
+    } else if (threadSafe) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        block = allocateInternal();
+    } else {
+        block = allocateInternal();
+    }
+    if (pressureRaised.load(std::memory_order_relaxed)) {
+        firePressure();
+    }
+    return block;
+}
+
+// Lock held. Plain pools only: an empty list may still have released pages
+// or quarantined blocks behind it, which allocateInternal() handles.
+inline void* MemoryPool::popFree() {
+    Block* block = freeList;
+    if (__builtin_expect(!block, 0)) {
         return allocateInternal();
     }
-    return allocateInternal();
+    freeList = block->next;
+    --freeBlockCount;
+    if (__builtin_expect(block == snapshotCursor, 0)) {
+        snapshotCursor = nullptr;
+    }
+    return block;
+}
+
+// Reserve blocks are only reachable under the lock (or single-threaded), so
+// high-priority requests skip the combining slots and take it directly
+void* MemoryPool::allocate(Priority priority) {
+    if (priority != Priority::High) {
+        return allocate();
+    }
+    void* block;
+    if (leakTracking || HeapProfiler::isActive()) {
+        block = allocateTracked(__builtin_return_address(0), false, nullptr, true);
+    } else if (cacheMode != PoolCache::None && (block = popCache()) != nullptr) {
+        // A parked block spares the reserve
+    } else if (threadSafe) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        block = allocateInternal(nullptr, true);
+    } else {
+        block = allocateInternal(nullptr, true);
+    }
+    if (pressureRaised.load(std::memory_order_relaxed)) {
+        firePressure();
+    }
+    return block;
+}
+
+void* MemoryPool::allocateWait(std::chrono::nanoseconds timeout) {
+    void* block = allocate();
+    if (block) {
+        return block;
+    }
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        // Announce first, then look again: a free that missed the count
+        // pushed its block before this second look
+        addWaiter();
+        uint32_t seen = freeEvents.load();
+        block = allocate();
+        std::chrono::nanoseconds remaining = deadline - std::chrono::steady_clock::now();
+        if (!block && remaining.count() > 0) {
+            futexWait(freeEvents, seen, remaining);
+            block = allocate();
+            remaining = deadline - std::chrono::steady_clock::now();
+        }
+        removeWaiter();
+        if (block || remaining.count() <= 0) {
+            return block;
+        }
+    }
 }
 
-void* MemoryPool::allocateInternal() {
+// seq_cst: a free checks for sleepers after its push, under the lock or,
+// in lock-free mode, after a seq_cst CAS
+void MemoryPool::addWaiter() {
+    slowPath.fetch_add(SLOW_WAITER);
+}
+
+void MemoryPool::removeWaiter() {
+    slowPath.fetch_sub(SLOW_WAITER);
+}
+
+bool MemoryPool::hasWaiters(std::memory_order order) const {
+    return (slowPath.load(order) & SLOW_WAITER_MASK) != 0;
+}
+
+void MemoryPool::setSlowBit(uint64_t bit, bool on) {
+    if (on) {
+        slowPath.fetch_or(bit);
+    } else {
+        slowPath.fetch_and(~bit);
+    }
+}
+
+void MemoryPool::wakeWaiters(int count) {
+    freeEvents.fetch_add(1);
+    futexWake(freeEvents, count);
+}
+
+// Lock held (none in lock-free mode): hand a free block to the oldest
+// queued async request
+bool MemoryPool::serveAsync() {
+    AsyncAllocator* async = asyncAllocator.load(std::memory_order_acquire);
+    return async && async->serve();
+}
+
+void MemoryPool::setWatermark(size_t usedBlocks) {
+    size_t free = (usedBlocks > 0 && usedBlocks <= totalBlocks) ? totalBlocks - usedBlocks : SIZE_MAX;
+    pressureFree.store(free, std::memory_order_relaxed);
+    setSlowBit(SLOW_WATERMARK, free != SIZE_MAX);
+}
+
+// Called with the new free count after every allocation from the free list.
+// Usage moves one block at a time, so equality catches every crossing.
+inline void MemoryPool::notePressure(size_t freeBlocks) {
+    if (__builtin_expect(freeBlocks == pressureFree.load(std::memory_order_relaxed), 0)) {
+        pressureRaised.store(true, std::memory_order_relaxed);
+    }
+}
+
+void MemoryPool::firePressure() {
+    if (pressureRaised.exchange(false) && onPressure) {
+        onPressure(*this);
+    }
+}
+
+void* MemoryPool::allocateTagged(const char* tag) {
+    void* block;
+    if (leakTracking || HeapProfiler::isActive()) {
+        block = allocateTracked(tag, true);
+    } else if (threadSafe) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        block = allocateInternal();
+    } else {
+        block = allocateInternal();
+    }
+    if (pressureRaised.load(std::memory_order_relaxed)) {
+        firePressure();
+    }
+    return block;
+}
+
+// Slow path for allocations that feed leak tracking or the heap profiler
+void* MemoryPool::allocateZeroed() {
+    bool knownZero = false;
+    void* ptr;
+    if (leakTracking || HeapProfiler::isActive()) {
+        ptr = allocateTracked(__builtin_return_address(0), false, &knownZero);
+    } else if (threadSafe) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        ptr = allocateInternal(&knownZero);
+    } else {
+        ptr = allocateInternal(&knownZero);
+    }
+
+    if (pressureRaised.load(std::memory_order_relaxed)) {
+        firePressure();
+    }
+
+    // Zeroing happens outside the lock; the block is ours now
+    if (ptr) {
+        if (knownZero) {
+            static_cast<Block*>(ptr)->next = nullptr;
+        } else {
+            std::memset(ptr, 0, blockSize);
+        }
+    }
+    return ptr;
+}
+
+void* MemoryPool::allocateTracked(const void* site, bool tagged, bool* knownZero, bool high) {
+    void* ptr;
+    {
+        std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+        if (threadSafe) {
+            lock.lock();
+        }
+        ptr = allocateInternal(knownZero, high);
+        if (ptr && leakTracking && --leakSampleCountdown == 0) {
+            leakSampleCountdown = leakSampleRate;
+            AllocationSite entry = { site, tagged };
+            liveSites[ptr] = entry;
+        }
+    }
+
+    // Stack capture happens outside the pool lock
+    if (ptr && HeapProfiler::isActive() && HeapProfiler::shouldSample(blockSize) && markSample(ptr)) {
+        HeapProfiler::recordAllocation(ptr, blockSize);
+        slowPath.fetch_add(SLOW_SAMPLE, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+void* MemoryPool::allocateInternal(bool* knownZero, bool high) {
+    if (lockFree) {
+        return popLockFree();
+    }
+
+    // The last highReserve free blocks are kept for Priority::High. With no
+    // reserve this only refuses what the pool could not hand out anyway.
+    if (freeBlockCount <= highReserve && !high) {
+        return nullptr;
+    }
+
     // Check if pool is exhausted
     if (!freeList) {
+        // Pages released by trim() are relinked before anything is refused
+        if (!releasedRuns.empty()) {
+            refillFromReleased();
+            return allocateInternal(knownZero, high);
+        }
+        // Quarantined blocks are still free; recycle the oldest rather than fail.
+        // They were handed out before, so they are never known-zero.
+        if (quarantineCount > 0) {
+            notePressure(--freeBlockCount);
+            Block* recycled = quarantinePop();
+            countLive(recycled, true);
+            return recycled;
+        }
         return nullptr;
     }
     
     // Pop from free list - FAST PATH
-    void* block = freeList;
+    Block* block = freeList;
     freeList = freeList->next;
-    --freeBlockCount;
+    notePressure(--freeBlockCount);
+    countLive(block, true);
+    if (block == snapshotCursor) {
+        snapshotCursor = nullptr;
+    }
     
+    // The caller may write to the block, so it stops being known-zero
+    if (!zeroBits.empty()) {
+        bool zero = takeZeroBit(block);
+        if (knownZero) {
+            *knownZero = zero;
+        }
+    }
     return block;
 }
 
+inline void MemoryPool::countLive(void* ptr, bool live) {
+    if (!pageLive.empty()) {
+        size_t page = (static_cast<char*>(ptr) - static_cast<char*>(memoryStart)) >> __builtin_ctzl(pageSize());
+        if (live) {
+            ++pageLive[page];
+        } else {
+            --pageLive[page];
+        }
+    }
+}
+
+bool MemoryPool::takeZeroBit(void* ptr) {
+    size_t index = (static_cast<char*>(ptr) - static_cast<char*>(memoryStart)) / blockSize;
+    uint64_t mask = uint64_t(1) << (index % 64);
+    bool zero = (zeroBits[index / 64] & mask) != 0;
+    zeroBits[index / 64] &= ~mask;
+    return zero;
+}
+
 void MemoryPool::deallocate(void* ptr) {
+    if (__builtin_expect(slowPath.load(std::memory_order_relaxed) != 0, 0)) {
+        deallocateSlow(ptr);
+        return;
+    }
+    if (threadSafe) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        pushFree(ptr);
+        // Sleepers count themselves without the lock, so a free that read
+        // slowPath before they did must still look for them under it
+        if (hasWaiters(std::memory_order_relaxed) && !serveAsync()) {
+            wakeWaiters(1);
+        }
+        return;
+    }
+    pushFree(ptr);
+}
+
+void MemoryPool::deallocateSlow(void* ptr) {
+    // Retire a profiler sample before the block can be handed out again
+    if (ptr) {
+        retireSample(ptr);
+    }
+    if (cacheMode != PoolCache::None && ptr) {
+        #ifdef MEMPOOL_SAFE_MODE
+        char* ptrAddr = static_cast<char*>(ptr);
+        char* startAddr = static_cast<char*>(memoryStart);
+        if (ptrAddr < startAddr || ptrAddr >= startAddr + blockSize * totalBlocks) {
+            throw std::invalid_argument("Pointer not from this pool");
+        }
+        #endif
+        if (!pushCache(ptr)) {
+            flushCache(ptr);
+        }
+        return;
+    }
+    if (flatCombining && ptr) {
+        // Checked here, so the combiner never throws for another thread
+        #ifdef MEMPOOL_SAFE_MODE
+        char* ptrAddr = static_cast<char*>(ptr);
+        char* startAddr = static_cast<char*>(memoryStart);
+        if (ptrAddr < startAddr || ptrAddr >= startAddr + blockSize * totalBlocks) {
+            throw std::invalid_argument("Pointer not from this pool");
+        }
+        #endif
+        combine(true, ptr);
+        return;
+    }
     if (threadSafe) {
         std::lock_guard<std::mutex> lock(poolMutex);
         deallocateInternal(ptr);
@@ -85,6 +977,420 @@ void MemoryPool::deallocate(void* ptr) {
     deallocateInternal(ptr);
 }
 
+// False if the bitmap cannot be allocated; the block then goes unsampled
+bool MemoryPool::markSample(void* ptr) {
+    uint64_t* bits = sampledBits.load(std::memory_order_acquire);
+    if (!bits) {
+        uint64_t* fresh = new (std::nothrow) uint64_t[(totalBlocks + 63) / 64]();
+        if (!fresh) {
+            return false;
+        }
+        if (sampledBits.compare_exchange_strong(bits, fresh, std::memory_order_acq_rel)) {
+            bits = fresh;
+        } else {
+            delete[] fresh;
+        }
+    }
+    size_t index = (static_cast<char*>(ptr) - static_cast<char*>(memoryStart)) / blockSize;
+    __atomic_fetch_or(&bits[index / 64], uint64_t(1) << (index % 64), __ATOMIC_RELAXED);
+    return true;
+}
+
+// Foreign pointers are left for the bounds check that follows
+void MemoryPool::retireSample(void* ptr) {
+    if ((slowPath.load(std::memory_order_relaxed) & SLOW_SAMPLE_MASK) == 0) {
+        return;
+    }
+    uint64_t* bits = sampledBits.load(std::memory_order_acquire);
+    size_t offset = static_cast<size_t>(static_cast<char*>(ptr) - static_cast<char*>(memoryStart));
+    if (!bits || offset >= blockSize * totalBlocks) {
+        return;
+    }
+    size_t index = offset / blockSize;
+    uint64_t mask = uint64_t(1) << (index % 64);
+    if ((__atomic_load_n(&bits[index / 64], __ATOMIC_RELAXED) & mask) == 0) {
+        return;
+    }
+    __atomic_fetch_and(&bits[index / 64], ~mask, __ATOMIC_RELAXED);
+    if (HeapProfiler::recordDeallocation(ptr)) {
+        slowPath.fetch_sub(SLOW_SAMPLE, std::memory_order_relaxed);
+    }
+}
+
+// Lock held. Plain pools only; deallocateInternal() without the options.
+inline void MemoryPool::pushFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    #ifdef MEMPOOL_SAFE_MODE
+    char* ptrAddr = static_cast<char*>(ptr);
+    char* startAddr = static_cast<char*>(memoryStart);
+    if (ptrAddr < startAddr || ptrAddr >= startAddr + blockSize * totalBlocks) {
+        throw std::invalid_argument("Pointer not from this pool");
+    }
+    #endif
+    Block* block = static_cast<Block*>(ptr);
+    block->next = freeList;
+    freeList = block;
+    ++freeBlockCount;
+}
+
+void MemoryPool::deallocateBatch(void* const* blocks, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (blocks[i]) {
+            retireSample(blocks[i]);
+        }
+    }
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    for (size_t i = 0; i < count; ++i) {
+        deallocateInternal(blocks[i]);
+    }
+}
+
+// Serve a request directly when the lock is free. Otherwise publish it,
+// then either become the combiner and serve every pending slot under
+// poolMutex, or wait for the combiner to serve ours.
+void* MemoryPool::combine(bool isFree, void* block) {
+    if (poolMutex.try_lock()) {
+        void* result = nullptr;
+        if (isFree) {
+            deallocateInternal(block);
+        } else {
+            result = allocateInternal();
+        }
+        serveCombining();
+        poolMutex.unlock();
+        return result;
+    }
+
+    if (combiningSlot == UINT32_MAX) {
+        combiningSlot = nextCombiningSlot.fetch_add(1, std::memory_order_relaxed) % COMBINING_SLOTS;
+    }
+
+    // Claim the preferred slot or the next free one; with every slot busy,
+    // fall back to waiting for the lock
+    CombiningSlot* mine = nullptr;
+    for (size_t probe = 0; probe < COMBINING_SLOTS && !mine; ++probe) {
+        size_t index = (combiningSlot + probe) % COMBINING_SLOTS;
+        CombiningSlot& slot = combining[index];
+        uint32_t expected = COMBINE_FREE;
+        if (slot.state.load(std::memory_order_relaxed) == COMBINE_FREE
+            && slot.state.compare_exchange_strong(expected, COMBINE_CLAIMED, std::memory_order_acquire)) {
+            mine = &slot;
+            // Combiners scan up to the highest slot ever published
+            size_t used = combiningUsed.load(std::memory_order_relaxed);
+            while (used <= index && !combiningUsed.compare_exchange_weak(used, index + 1)) {
+            }
+        }
+    }
+    if (!mine) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (isFree) {
+            deallocateInternal(block);
+            return nullptr;
+        }
+        return allocateInternal();
+    }
+    mine->isFree = isFree;
+    mine->block = block;
+    // Counted before it is visible, so the count never runs behind
+    combiningPending.fetch_add(1, std::memory_order_relaxed);
+    mine->state.store(COMBINE_PENDING, std::memory_order_seq_cst);
+
+    int spins = 0;
+    while (mine->state.load(std::memory_order_acquire) != COMBINE_DONE) {
+        if (poolMutex.try_lock()) {
+            serveCombining();
+            poolMutex.unlock();
+            continue;
+        }
+        if (++spins < combineSpins()) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    void* result = mine->block;
+    mine->state.store(COMBINE_FREE, std::memory_order_release);
+    return result;
+}
+
+// poolMutex held. Uncontended calls find nothing pending and skip the
+// scan; a request published after the check is served by its own thread.
+void MemoryPool::serveCombining() {
+    if (combiningPending.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    size_t used = combiningUsed.load(std::memory_order_acquire);
+    for (size_t i = 0; i < used; ++i) {
+        CombiningSlot& slot = combining[i];
+        if (slot.state.load(std::memory_order_acquire) != COMBINE_PENDING) {
+            continue;
+        }
+        if (slot.isFree) {
+            deallocateInternal(slot.block);
+        } else {
+            slot.block = allocateInternal();
+        }
+        combiningPending.fetch_sub(1, std::memory_order_relaxed);
+        slot.state.store(COMBINE_DONE, std::memory_order_release);
+    }
+}
+
+CacheSlab* MemoryPool::threadSlab() {
+    return lastSlabPool == poolId ? lastSlab : findThreadSlab();
+}
+
+CacheSlab* MemoryPool::findThreadSlab() {
+    std::vector<ThreadSlabEntry>& entries = threadSlabs.entries;
+    for (const ThreadSlabEntry& entry : entries) {
+        if (entry.poolId == poolId) {
+            lastSlabPool = poolId;
+            lastSlab = entry.slab;
+            return entry.slab;
+        }
+    }
+
+    // Drop slabs of pools destroyed while this thread was running
+    if (entries.size() >= 16) {
+        std::lock_guard<std::mutex> lock(cachePoolsMutex());
+        for (size_t i = entries.size(); i-- > 0;) {
+            if (!liveCachePools().count(entries[i].poolId)) {
+                delete entries[i].slab;
+                entries.erase(entries.begin() + i);
+            }
+        }
+    }
+
+    CacheSlab* slab = new CacheSlab();
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        threadSlabList.push_back(slab);
+    }
+    ThreadSlabEntry entry = { this, poolId, slab };
+    entries.push_back(entry);
+    lastSlabPool = poolId;
+    lastSlab = slab;
+    return slab;
+}
+
+// Called by an exiting thread while the pool is known to be alive
+void MemoryPool::releaseThreadSlab(CacheSlab* slab) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (size_t i = 0; i < slab->count; ++i) {
+        Block* block = static_cast<Block*>(slab->slots[i]);
+        block->next = freeList;
+        freeList = block;
+    }
+    freeBlockCount += slab->count;
+    threadSlabList.erase(std::find(threadSlabList.begin(), threadSlabList.end(), slab));
+    if (slab->count > 0 && hasWaiters(std::memory_order_relaxed)) {
+        wakeWaiters(static_cast<int>(slab->count));
+    }
+}
+
+// Slab counts are written with relaxed atomic stores so cachedBlockCount()
+// can read them from other threads; on x86 these are plain moves.
+bool MemoryPool::pushCache(void* block) {
+    size_t capacity = cacheBlocks.load(std::memory_order_relaxed);
+    if (cacheMode == PoolCache::PerCpu) {
+        return CpuCache::push(cpuSlabs, capacity, block);
+    }
+    CacheSlab* slab = threadSlab();
+    if (slab->count >= capacity) {
+        return false;
+    }
+    slab->slots[slab->count] = block;
+    __atomic_store_n(&slab->count, slab->count + 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void* MemoryPool::popCache() {
+    if (cacheMode == PoolCache::PerCpu) {
+        return CpuCache::pop(cpuSlabs);
+    }
+    CacheSlab* slab = threadSlab();
+    if (slab->count == 0) {
+        return nullptr;
+    }
+    __atomic_store_n(&slab->count, slab->count - 1, __ATOMIC_RELAXED);
+    return slab->slots[slab->count];
+}
+
+// Slab empty: take half a slab from the free list under one lock, keep
+// one block and park the rest
+void* MemoryPool::refillCache() {
+    void* blocks[CpuCache::MAX_BLOCKS];
+    size_t batch = cacheBatch(cacheBlocks.load(std::memory_order_relaxed));
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        while (count < batch && (blocks[count] = allocateInternal()) != nullptr) {
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return nullptr;
+    }
+
+    // Another thread on this CPU may have filled the slab meanwhile
+    size_t parked = 1;
+    while (parked < count && pushCache(blocks[parked])) {
+        ++parked;
+    }
+    if (parked < count) {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        for (size_t i = parked; i < count; ++i) {
+            deallocateInternal(blocks[i]);
+        }
+    }
+    return blocks[0];
+}
+
+// Slab full: return block and half a slab to the free list under one lock
+void MemoryPool::flushCache(void* block) {
+    void* blocks[CpuCache::MAX_BLOCKS + 1];
+    size_t batch = cacheBatch(cacheBlocks.load(std::memory_order_relaxed));
+    size_t count = 0;
+    blocks[count++] = block;
+    while (count <= batch && (blocks[count] = popCache()) != nullptr) {
+        ++count;
+    }
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (size_t i = 0; i < count; ++i) {
+        deallocateInternal(blocks[i]);
+    }
+}
+
+// Per-thread slabs need poolMutex held (or the pool quiescent)
+size_t MemoryPool::cachedBlockCount() {
+    size_t cached = 0;
+    if (cacheMode == PoolCache::PerCpu) {
+        for (size_t cpu = 0; cpu < cpuSlabCount; ++cpu) {
+            cached += __atomic_load_n(&cpuSlabs[cpu].count, __ATOMIC_RELAXED);
+        }
+    }
+    for (CacheSlab* slab : threadSlabList) {
+        cached += __atomic_load_n(&slab->count, __ATOMIC_RELAXED);
+    }
+    return cached;
+}
+
+CacheStats MemoryPool::getCacheStats() {
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    CacheStats stats;
+    stats.mode = cacheMode;
+    stats.slabs = cacheMode == PoolCache::PerCpu ? cpuSlabCount : threadSlabList.size();
+    stats.cachedBlocks = cachedBlockCount();
+    return stats;
+}
+
+void MemoryPool::setLockFreeHead(Block* first) {
+    uint64_t tag = (lockFreeHead.load(std::memory_order_relaxed) >> headOffsetBits) + 1;
+    uint64_t slot = first ? (reinterpret_cast<char*>(first) - static_cast<char*>(memoryStart)) / 16 + 1 : 0;
+    lockFreeHead.store(tag << headOffsetBits | slot, std::memory_order_release);
+}
+
+// Treiber stack pop. The next link is read from a block another thread may
+// already have allocated and overwritten; the tag then no longer matches
+// and the CAS fails, so a stale link is never installed.
+void* MemoryPool::popLockFree() {
+    char* start = static_cast<char*>(memoryStart);
+    uint64_t head = lockFreeHead.load(std::memory_order_seq_cst);
+    while (true) {
+        uint64_t slot = head & headOffsetMask;
+        if (slot == 0) {
+            // Empty, but a deallocate() may be offering a block right now
+            return elimination.empty() ? nullptr : takeOfferedBlock();
+        }
+        Block* block = reinterpret_cast<Block*>(start + (slot - 1) * 16);
+        Block* next = __atomic_load_n(&block->next, __ATOMIC_RELAXED);
+        uint64_t nextSlot = next ? (reinterpret_cast<char*>(next) - start) / 16 + 1 : 0;
+        uint64_t tag = (head >> headOffsetBits) + 1;
+        if (lockFreeHead.compare_exchange_weak(head, tag << headOffsetBits | nextSlot,
+                                               std::memory_order_acquire, std::memory_order_acquire)) {
+            notePressure(__atomic_sub_fetch(&freeBlockCount, 1, __ATOMIC_RELAXED));
+            return block;
+        }
+        if (!elimination.empty()) {
+            if (void* offered = takeOfferedBlock()) {
+                return offered;
+            }
+            head = lockFreeHead.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void MemoryPool::pushLockFree(Block* block) {
+    uint64_t slot = (reinterpret_cast<char*>(block) - static_cast<char*>(memoryStart)) / 16 + 1;
+    uint64_t head = lockFreeHead.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t top = head & headOffsetMask;
+        Block* next = top ? reinterpret_cast<Block*>(static_cast<char*>(memoryStart) + (top - 1) * 16) : nullptr;
+        __atomic_store_n(&block->next, next, __ATOMIC_RELAXED);
+        uint64_t tag = (head >> headOffsetBits) + 1;
+        // seq_cst against the waiters check that follows; same code on x86
+        if (lockFreeHead.compare_exchange_weak(head, tag << headOffsetBits | slot,
+                                               std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            __atomic_fetch_add(&freeBlockCount, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        if (!elimination.empty() && offerBlock(block)) {
+            return;
+        }
+    }
+}
+
+// Park block in a random empty slot and wait briefly for an allocate() to
+// take it. A completed exchange leaves freeBlockCount and the head alone.
+bool MemoryPool::offerBlock(Block* block) {
+    EliminationSlot& slot = elimination[randomSlot(elimination.size())];
+    uintptr_t expected = SLOT_EMPTY;
+    if (!slot.value.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(block),
+                                            std::memory_order_release, std::memory_order_relaxed)) {
+        return false;
+    }
+    for (int spin = 0; spin < ELIMINATION_SPINS; ++spin) {
+        if (slot.value.load(std::memory_order_acquire) == SLOT_TAKEN) {
+            break;
+        }
+        cpuRelax();
+    }
+
+    // Withdraw the offer; failing means a partner took it at the last moment
+    expected = reinterpret_cast<uintptr_t>(block);
+    if (slot.value.compare_exchange_strong(expected, SLOT_EMPTY, std::memory_order_relaxed)) {
+        return false;
+    }
+    slot.exchanges.fetch_add(1, std::memory_order_relaxed);
+    slot.value.store(SLOT_EMPTY, std::memory_order_release);
+    return true;
+}
+
+void* MemoryPool::takeOfferedBlock() {
+    EliminationSlot& slot = elimination[randomSlot(elimination.size())];
+    uintptr_t value = slot.value.load(std::memory_order_acquire);
+    if (value > SLOT_TAKEN && slot.value.compare_exchange_strong(value, SLOT_TAKEN, std::memory_order_acquire,
+                                                                 std::memory_order_relaxed)) {
+        return reinterpret_cast<void*>(value);
+    }
+    return nullptr;
+}
+
+size_t MemoryPool::getEliminatedPairs() const {
+    size_t pairs = 0;
+    for (const EliminationSlot& slot : elimination) {
+        pairs += slot.exchanges.load(std::memory_order_relaxed);
+    }
+    return pairs;
+}
+
 void MemoryPool::deallocateInternal(void* ptr) {
     if (!ptr) {
         return;
@@ -101,43 +1407,471 @@ void MemoryPool::deallocateInternal(void* ptr) {
     }
     #endif
     
-    // Push to free list - FAST PATH
+    if (leakTracking && !liveSites.empty()) {
+        liveSites.erase(ptr);
+    }
+    countLive(ptr, false);
+
     Block* block = static_cast<Block*>(ptr);
-    block->next = freeList;
-    freeList = block;
+    if (lockFree) {
+        pushLockFree(block);
+        if (hasWaiters() && !serveAsync()) {
+            wakeWaiters(1);
+        }
+        return;
+    }
+    if (!quarantine.empty()) {
+        quarantinePush(block);
+    } else {
+        // Push to free list - FAST PATH
+        block->next = freeList;
+        freeList = block;
+    }
     ++freeBlockCount;
+
+    // Read under the lock allocateWait() rechecks with, so it cannot be missed
+    if (hasWaiters(std::memory_order_relaxed) && !serveAsync()) {
+        wakeWaiters(1);
+    }
 }
 
-void MemoryPool::reset() {
+void MemoryPool::quarantinePush(Block* block) {
+    // Ring full: the oldest block has served its time, recycle it first
+    if (quarantineCount == quarantine.size()) {
+        Block* oldest = quarantinePop();
+        oldest->next = freeList;
+        freeList = oldest;
+    }
+
+    std::memset(block, QUARANTINE_POISON, poisonBytes);
+    size_t tail = quarantineHead + quarantineCount;
+    if (tail >= quarantine.size()) {
+        tail -= quarantine.size();
+    }
+    quarantine[tail] = block;
+    ++quarantineCount;
+}
+
+MemoryPool::Block* MemoryPool::quarantinePop() {
+    Block* block = quarantine[quarantineHead];
+    if (++quarantineHead == quarantine.size()) {
+        quarantineHead = 0;
+    }
+    --quarantineCount;
+    ++quarantineReleased;
+
+    // Any word that lost its poison was written after deallocate().
+    // poisonBytes is a multiple of max_align_t, so whole words cover it.
+    uint64_t poison;
+    std::memset(&poison, QUARANTINE_POISON, sizeof(poison));
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(block);
+    uint64_t diff = 0;
+    for (size_t i = 0; i < poisonBytes / sizeof(uint64_t); ++i) {
+        diff |= words[i] ^ poison;
+    }
+    if (diff != 0) {
+        ++quarantineCorruptions;
+        std::cerr << "WARNING: Use-after-free detected! Block " << static_cast<void*>(block)
+                  << " was modified while quarantined.\n";
+    }
+    return block;
+}
+
+size_t MemoryPool::sampleUsedBlocks() {
+    if (lockFree) {
+        return totalBlocks - __atomic_load_n(&freeBlockCount, __ATOMIC_RELAXED);
+    }
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
     if (threadSafe) {
-        std::lock_guard<std::mutex> lock(poolMutex);
-   	 freeBlockCount = totalBlocks;
-    
-	    // Rebuild free list
-	    freeList = static_cast<Block*>(memoryStart);
-	    Block* current = freeList;
-	    
-	    for (size_t i = 0; i < totalBlocks - 1; ++i) {
-		void* nextAddr = static_cast<char*>(static_cast<void*>(current)) + blockSize;
-		current->next = static_cast<Block*>(nextAddr);
-		current = current->next;
-	    }
-	    current->next = nullptr;
+        lock.lock();
+    }
+    return totalBlocks - freeBlockCount;
+}
 
+QuarantineStats MemoryPool::getQuarantineStats() {
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
     }
-    
+    QuarantineStats stats;
+    stats.capacity = quarantine.size();
+    stats.held = quarantineCount;
+    stats.released = quarantineReleased;
+    stats.corruptions = quarantineCorruptions;
+    return stats;
+}
+
+std::vector<LeakSite> MemoryPool::collectLeaks() {
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+
+    // Group live blocks by site; a site is its id plus whether it is a tag
+    std::vector<LeakSite> sites;
+    std::map<std::pair<const void*, bool>, size_t> index;
+    for (const auto& entry : liveSites) {
+        const AllocationSite& site = entry.second;
+        auto inserted = index.insert(std::make_pair(std::make_pair(site.id, site.tagged), sites.size()));
+        if (inserted.second) {
+            LeakSite leak = { site.id, site.tagged, 0, 0 };
+            sites.push_back(leak);
+        }
+        LeakSite& leak = sites[inserted.first->second];
+        ++leak.blocks;
+        leak.bytes += blockSize;
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const LeakSite& a, const LeakSite& b) {
+        return a.bytes > b.bytes;
+    });
+    return sites;
+}
+
+void MemoryPool::reportLeaks(std::ostream& out) {
+    std::vector<LeakSite> sites = collectLeaks();
+    if (sites.empty()) {
+        return;
+    }
+
+    // Resolve return addresses in one go; tags are printed as-is
+    std::vector<void*> addresses;
+    for (const LeakSite& leak : sites) {
+        if (!leak.tagged) {
+            addresses.push_back(const_cast<void*>(leak.site));
+        }
+    }
+    char** symbols = addresses.empty() ? nullptr
+        : backtrace_symbols(addresses.data(), static_cast<int>(addresses.size()));
+
+    out << "Leaked blocks by allocation site";
+    if (leakSampleRate > 1) {
+        out << " (sampled 1 in " << leakSampleRate << ", counts are estimates)";
+    }
+    out << ":\n";
+
+    size_t symbol = 0;
+    for (const LeakSite& leak : sites) {
+        out << "  " << leak.blocks * leakSampleRate << " blocks, "
+            << leak.bytes * leakSampleRate << " bytes at ";
+        if (leak.tagged) {
+            out << "[" << static_cast<const char*>(leak.site) << "]";
+        } else if (symbols) {
+            out << symbols[symbol++];
+        } else {
+            out << leak.site;
+        }
+        out << "\n";
+    }
+    std::free(symbols);
+}
+
+void MemoryPool::drainQuarantine() {
+    while (quarantineCount > 0) {
+        Block* block = quarantinePop();
+        block->next = freeList;
+        freeList = block;
+    }
+}
+
+void MemoryPool::refillFromReleased() {
+    // Link a bounded slice of the last released run; the rest stays released
+    std::pair<size_t, size_t>& run = releasedRuns.back();
+    size_t count = std::max<size_t>(1, REFILL_BYTES / blockSize);
+    size_t begin = run.second - run.first > count ? run.second - count : run.first;
+
+    char* start = static_cast<char*>(memoryStart);
+    for (size_t i = run.second; i-- > begin;) {
+        Block* block = reinterpret_cast<Block*>(start + i * blockSize);
+        block->next = freeList;
+        freeList = block;
+    }
+    run.second = begin;
+    if (run.first == run.second) {
+        releasedRuns.pop_back();
+    }
+}
+
+size_t MemoryPool::trim() {
+    // Released runs would need the lock the lock-free head does without
+    if (lockFree) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    drainQuarantine();
+
+    // Free blocks are those on the free list plus those already released
+    std::vector<bool> isFree(totalBlocks, false);
+    char* start = static_cast<char*>(memoryStart);
+    for (Block* block = freeList; block; block = block->next) {
+        isFree[(reinterpret_cast<char*>(block) - start) / blockSize] = true;
+    }
+    for (const auto& run : releasedRuns) {
+        std::fill(isFree.begin() + run.first, isFree.begin() + run.second, true);
+    }
+
+    // A page can go back to the OS when every block touching it is free.
+    // Those blocks leave the free list; refillFromReleased() relinks them.
+    std::vector<bool> released(totalBlocks, false);
+    size_t releasedBytes = 0;
+    size_t pages = keepResident ? 0 : (blockSize * totalBlocks) / pageSize();
+    std::vector<bool> pageReleased(pages, false);
+    for (size_t page = 0; page < pages; ++page) {
+        size_t first = page * pageSize() / blockSize;
+        size_t last = ((page + 1) * pageSize() - 1) / blockSize;
+        bool allFree = true;
+        for (size_t i = first; i <= last && allFree; ++i) {
+            allFree = isFree[i];
+        }
+        if (!allFree) {
+            continue;
+        }
+        madvise(start + page * pageSize(), pageSize(), MADV_DONTNEED);
+        std::fill(released.begin() + first, released.begin() + last + 1, true);
+        pageReleased[page] = true;
+        releasedBytes += pageSize();
+    }
+
+    // Blocks lying entirely in released pages read back as zero
+    if (!zeroBits.empty()) {
+        for (size_t i = 0; i < totalBlocks; ++i) {
+            size_t firstPage = i * blockSize / pageSize();
+            size_t lastPage = ((i + 1) * blockSize - 1) / pageSize();
+            bool zero = released[i] && lastPage < pages;
+            for (size_t page = firstPage; zero && page <= lastPage; ++page) {
+                zero = pageReleased[page];
+            }
+            if (zero) {
+                zeroBits[i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+    }
+
+    // Rebuild the free list in address order from what is still resident
+    releasedRuns.clear();
+    freeList = nullptr;
+    snapshotCursor = nullptr;
+    for (size_t i = totalBlocks; i-- > 0;) {
+        if (released[i]) {
+            if (releasedRuns.empty() || releasedRuns.back().first != i + 1) {
+                releasedRuns.push_back(std::make_pair(i, i + 1));
+            } else {
+                releasedRuns.back().first = i;
+            }
+        } else if (isFree[i]) {
+            Block* block = reinterpret_cast<Block*>(start + i * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+    return releasedBytes;
+}
+
+bool MemoryPool::setTunable(const std::string& key, size_t value) {
+    std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+    if (threadSafe) {
+        lock.lock();
+    }
+    if (key == "quarantine_blocks") {
+        // Same restrictions as the constructor: caches and the lock-free
+        // head bypass the paths that fill the quarantine
+        if (cacheMode != PoolCache::None || lockFree || value > totalBlocks) {
+            return false;
+        }
+        drainQuarantine();
+        quarantineHead = 0;
+        quarantine.assign(value, nullptr);
+        setSlowBit(SLOW_QUARANTINE, value > 0);
+        return true;
+    }
+    if (key == "cache_blocks" && value > 0 && value <= CpuCache::MAX_BLOCKS) {
+        // Slabs above the new capacity drain on their next full push
+        cacheBlocks.store(value, std::memory_order_relaxed);
+        return cacheMode != PoolCache::None;
+    }
+    if (key == "soft_watermark" && value <= totalBlocks) {
+        setWatermark(value);
+        return true;
+    }
+    if (key == "high_priority_reserve" && value < totalBlocks && !lockFree) {
+        highReserve = value;
+        setSlowBit(SLOW_RESERVE, value > 0);
+        return true;
+    }
+    if (key == "init_threads" && value > 0) {
+        initThreads = value;
+        return true;
+    }
+    if (key == "leak_sample_rate" && value > 0) {
+        leakSampleRate = value;
+        leakSampleCountdown = 1;
+        return leakTracking;
+    }
+    return false;
+}
+
+PoolSnapshot MemoryPool::takeSnapshot() {
+    PoolSnapshot snapshot;
+    snapshot.requestedSize = requestedSize;
+    snapshot.blockSize = blockSize;
+    snapshot.totalBlocks = totalBlocks;
+    snapshot.pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    uintptr_t base = reinterpret_cast<uintptr_t>(memoryStart);
+    snapshot.firstBlockOffset = base % snapshot.pageSize;
+    size_t span = snapshot.firstBlockOffset + blockSize * totalBlocks;
+    size_t pages = (span + snapshot.pageSize - 1) / snapshot.pageSize;
+
+    // Tracked counts are copied as they are; the page count never changes
+    if (!pageLive.empty()) {
+        std::vector<uint16_t> counts(pageLive.size());
+        {
+            std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+            if (threadSafe) {
+                lock.lock();
+            }
+            std::copy(pageLive.begin(), pageLive.end(), counts.begin());
+            snapshot.quarantinedBlocks = quarantineCount;
+            snapshot.liveBlocks = totalBlocks - freeBlockCount;
+        }
+        counts.resize(pages);
+        snapshot.pageLiveBlocks.swap(counts);
+        return snapshot;
+    }
+
+    // One bit per block, sized before taking the lock
+    std::vector<uint64_t> freeBits((totalBlocks + 63) / 64, 0);
+    char* start = static_cast<char*>(memoryStart);
+    auto markFree = [&](size_t index) {
+        freeBits[index / 64] |= uint64_t(1) << (index % 64);
+    };
+    {
+        std::lock_guard<std::mutex> serial(snapshotMutex);
+        std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+        if (threadSafe) {
+            lock.lock();
+        }
+        Block* block = freeList;
+        if (lockFree) {
+            uint64_t slot = lockFreeHead.load(std::memory_order_acquire) & headOffsetMask;
+            block = slot ? reinterpret_cast<Block*>(start + (slot - 1) * 16) : nullptr;
+        }
+
+        // A locked pool gets the lock back between batches. Pushes land
+        // above the cursor; a pop that reaches it restarts the walk.
+        size_t batch = 0, restarts = 0;
+        while (block) {
+            markFree((reinterpret_cast<char*>(block) - start) / blockSize);
+            block = block->next;
+            if (threadSafe && block && ++batch == SNAPSHOT_BATCH_BLOCKS && restarts < SNAPSHOT_MAX_RESTARTS) {
+                batch = 0;
+                snapshotCursor = block;
+                lock.unlock();
+                lock.lock();
+                if (!snapshotCursor) {
+                    std::fill(freeBits.begin(), freeBits.end(), 0);
+                    block = freeList;
+                    ++restarts;
+                }
+                snapshotCursor = nullptr;
+            }
+        }
+
+        // Released runs are marked a word at a time, not a block at a time
+        for (const auto& run : releasedRuns) {
+            size_t index = run.first;
+            for (; index < run.second && index % 64 != 0; ++index) {
+                markFree(index);
+            }
+            for (; index + 64 <= run.second; index += 64) {
+                freeBits[index / 64] = ~uint64_t(0);
+            }
+            for (; index < run.second; ++index) {
+                markFree(index);
+            }
+        }
+        for (size_t i = 0; i < quarantineCount; ++i) {
+            size_t slot = (quarantineHead + i) % quarantine.size();
+            markFree((reinterpret_cast<char*>(quarantine[slot]) - start) / blockSize);
+        }
+        snapshot.quarantinedBlocks = quarantineCount;
+        snapshot.liveBlocks = totalBlocks - freeBlockCount;
+    }
+
+    // Count live blocks per page with the pool running again
+    snapshot.pageLiveBlocks.assign(pages, 0);
+    for (size_t i = 0; i < totalBlocks; ++i) {
+        if (!(freeBits[i / 64] & (uint64_t(1) << (i % 64)))) {
+            size_t page = (snapshot.firstBlockOffset + i * blockSize) / snapshot.pageSize;
+            ++snapshot.pageLiveBlocks[page];
+        }
+    }
+    return snapshot;
+}
+
+void MemoryPool::reset() {
+    {
+        std::unique_lock<std::mutex> lock(poolMutex, std::defer_lock);
+        if (threadSafe) {
+            lock.lock();
+        }
+        resetInternal();
+        // Blocks reserved for async requests were just freed with the rest
+        AsyncAllocator* async = asyncAllocator.load(std::memory_order_acquire);
+        if (async) {
+            async->requeueCompleted();
+            while (async->serve()) {
+            }
+        }
+    }
+    if (hasWaiters()) {
+        wakeWaiters(INT_MAX);
+    }
+}
+
+void MemoryPool::resetInternal() {
+    liveSites.clear();
+    releasedRuns.clear();
+    snapshotCursor = nullptr;
+    if ((slowPath.load(std::memory_order_relaxed) & SLOW_SAMPLE_MASK) != 0) {
+        HeapProfiler::recordRangeFreed(memoryStart, static_cast<char*>(memoryStart) + blockSize * totalBlocks);
+        slowPath.fetch_and(~SLOW_SAMPLE_MASK, std::memory_order_relaxed);
+        uint64_t* bits = sampledBits.load(std::memory_order_relaxed);
+        std::fill(bits, bits + (totalBlocks + 63) / 64, uint64_t(0));
+    }
+    quarantineHead = 0;
+    quarantineCount = 0;
     freeBlockCount = totalBlocks;
+    std::fill(pageLive.begin(), pageLive.end(), 0);
+    for (EliminationSlot& slot : elimination) {
+        slot.value.store(SLOT_EMPTY, std::memory_order_relaxed);
+    }
+
+    // Cached blocks are rebuilt into the free list like all the others
+    for (size_t cpu = 0; cpu < cpuSlabCount; ++cpu) {
+        cpuSlabs[cpu].count = 0;
+    }
+    for (CacheSlab* slab : threadSlabList) {
+        __atomic_store_n(&slab->count, 0, __ATOMIC_RELAXED);
+    }
+    
+    if (zeroOnReset) {
+        buildFreeList(static_cast<char*>(memoryStart), blockSize, totalBlocks, initThreads, true, false);
+        freeList = static_cast<Block*>(memoryStart);
+        setLockFreeHead(freeList);
+        if (!zeroBits.empty()) {
+            std::fill(zeroBits.begin(), zeroBits.end(), ~uint64_t(0));
+        }
+        return;
+    }
     
     // Rebuild free list
+    buildFreeList(static_cast<char*>(memoryStart), blockSize, totalBlocks, initThreads, false, false);
     freeList = static_cast<Block*>(memoryStart);
-    Block* current = freeList;
-    
-    for (size_t i = 0; i < totalBlocks - 1; ++i) {
-        void* nextAddr = static_cast<char*>(static_cast<void*>(current)) + blockSize;
-        current->next = static_cast<Block*>(nextAddr);
-        current = current->next;
-    }
-    current->next = nullptr;
+    setLockFreeHead(freeList);
 }
 
 size_t MemoryPool::alignSize(size_t size, size_t alignment) {
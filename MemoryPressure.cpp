@@ -0,0 +1,169 @@
+#include "MemoryPressure.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> reservedBytes(0);
+std::atomic<size_t> growableBytes(0);
+std::atomic<size_t> hardLimit(0);
+
+struct Watermark {
+    int id;
+    size_t softLimit;
+    MemoryPressure::Callback callback;
+};
+
+// Never destroyed: pools with static storage release after static destructors
+std::mutex& watermarkMutex() {
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+std::vector<Watermark>& watermarks() {
+    static std::vector<Watermark>* list = new std::vector<Watermark>();
+    return *list;
+}
+
+int nextWatermarkId = 1;
+
+// Lowest soft limit, so reservations below every watermark skip the lock
+std::atomic<size_t> lowestSoftLimit(SIZE_MAX);
+
+void updateLowestSoftLimit() {
+    size_t lowest = SIZE_MAX;
+    for (const Watermark& watermark : watermarks()) {
+        if (watermark.softLimit < lowest) {
+            lowest = watermark.softLimit;
+        }
+    }
+    lowestSoftLimit.store(lowest, std::memory_order_relaxed);
+}
+
+// Callbacks run outside the lock so they may add or remove watermarks
+void fireCrossed(size_t before, size_t after) {
+    std::vector<MemoryPressure::Callback> crossed;
+    {
+        std::lock_guard<std::mutex> lock(watermarkMutex());
+        for (const Watermark& watermark : watermarks()) {
+            if (before < watermark.softLimit && after >= watermark.softLimit) {
+                crossed.push_back(watermark.callback);
+            }
+        }
+    }
+    for (const MemoryPressure::Callback& callback : crossed) {
+        callback(after);
+    }
+}
+
+bool readNumber(const std::string& path, size_t& value) {
+    std::ifstream in(path);
+    std::string text;
+    if (!(in >> text) || text == "max") {
+        return false;
+    }
+    value = std::stoull(text);
+    return true;
+}
+
+} // namespace
+
+bool MemoryPressure::reserve(size_t bytes, bool growable) {
+    if (growable) {
+        size_t limit = hardLimit.load(std::memory_order_relaxed);
+        size_t current = growableBytes.load(std::memory_order_relaxed);
+        do {
+            if (limit != 0 && current + bytes > limit) {
+                return false;
+            }
+        } while (!growableBytes.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed));
+    }
+    size_t before = reservedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (before + bytes >= lowestSoftLimit.load(std::memory_order_relaxed)) {
+        fireCrossed(before, before + bytes);
+    }
+    return true;
+}
+
+void MemoryPressure::release(size_t bytes, bool growable) {
+    if (growable) {
+        growableBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+    reservedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryPressure::setHardLimit(size_t bytes) {
+    hardLimit.store(bytes, std::memory_order_relaxed);
+}
+
+size_t MemoryPressure::getHardLimit() {
+    return hardLimit.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPressure::getReservedBytes() {
+    return reservedBytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryPressure::getGrowableBytes() {
+    return growableBytes.load(std::memory_order_relaxed);
+}
+
+int MemoryPressure::addCallback(size_t softLimitBytes, Callback callback) {
+    std::lock_guard<std::mutex> lock(watermarkMutex());
+    Watermark watermark = { nextWatermarkId++, softLimitBytes, callback };
+    watermarks().push_back(watermark);
+    updateLowestSoftLimit();
+    return watermark.id;
+}
+
+void MemoryPressure::removeCallback(int id) {
+    std::lock_guard<std::mutex> lock(watermarkMutex());
+    std::vector<Watermark>& list = watermarks();
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (list[i].id == id) {
+            list.erase(list.begin() + i);
+            break;
+        }
+    }
+    updateLowestSoftLimit();
+}
+
+bool MemoryPressure::readCgroupMemory(CgroupMemory& memory) {
+    // The v2 hierarchy is the "0::<path>" line
+    std::ifstream cgroups("/proc/self/cgroup");
+    std::string line;
+    std::string path;
+    while (std::getline(cgroups, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            path = line.substr(3);
+            break;
+        }
+    }
+    if (path.empty()) {
+        return false;
+    }
+    // Mounted alone, or next to v1 controllers on hybrid systems
+    const char* roots[] = { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" };
+    for (const char* root : roots) {
+        std::string dir = std::string(root) + (path == "/" ? "" : path);
+        if (readNumber(dir + "/memory.max", memory.max) && readNumber(dir + "/memory.current", memory.current)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MemoryPressure::applyCgroupLimits() {
+    CgroupMemory memory;
+    if (!readCgroupMemory(memory)) {
+        return false;
+    }
+    size_t headroom = memory.max > memory.current ? memory.max - memory.current : 0;
+    setHardLimit(std::max<size_t>(1, getGrowableBytes() + headroom / 10 * 9));
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef MEMORY_PRESSURE_H
+#define MEMORY_PRESSURE_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+
+struct CgroupMemory {
+    size_t max;                     // memory.max
+    size_t current;                 // memory.current
+};
+
+// Process-wide accounting of the bytes pools reserve from the OS.
+//
+// Every MemoryPool reserves its mapping here. Growable pools (BasicPool with
+// BudgetedBacking, the small-object allocator's regions) reserve each chunk
+// before mapping it; those reservations are refused past the hard limit, so
+// growth fails like exhaustion instead of running the process out of
+// memory. Fixed pools are counted but never refused.
+//
+// Callbacks fire when the total reserved by all pools rises past their soft
+// watermark, so caches of pooled objects can shed entries early. They run on
+// the thread whose reservation crossed the watermark, possibly while a
+// growing pool holds its lock: free into MemoryPools there, but do not
+// allocate from or free to growable pools.
+class MemoryPressure {
+public:
+    typedef std::function<void(size_t reservedBytes)> Callback;
+
+    // growable reservations fail if they would take the growable total past
+    // the hard limit
+    static bool reserve(size_t bytes, bool growable);
+    static void release(size_t bytes, bool growable);
+
+    // Bytes growable pools may hold in total (0 = unlimited)
+    static void setHardLimit(size_t bytes);
+    static size_t getHardLimit();
+
+    static size_t getReservedBytes();          // All pools
+    static size_t getGrowableBytes();          // Growable pools only
+
+    // Returns an id for removeCallback()
+    static int addCallback(size_t softLimitBytes, Callback callback);
+    static void removeCallback(int id);
+
+    // This process's cgroup v2 memory.max and memory.current; false outside
+    // cgroup v2 or without a limit
+    static bool readCgroupMemory(CgroupMemory& memory);
+
+    // Hard limit = growable bytes now + 90% of the cgroup's headroom, so
+    // pools fail allocations before the OOM killer steps in
+    static bool applyCgroupLimits();
+};
+
+// Backing policy for BasicPool that reserves every chunk in the growable
+// budget before taking it from Inner; a refused chunk fails the growth
+template <class Inner>
+struct BudgetedBacking : Inner {
+    void* acquire(size_t bytes) {
+        if (!MemoryPressure::reserve(bytes, true)) {
+            throw std::bad_alloc();
+        }
+        try {
+            return Inner::acquire(bytes);
+        } catch (...) {
+            MemoryPressure::release(bytes, true);
+            throw;
+        }
+    }
+    void release(void* memory, size_t bytes) {
+        Inner::release(memory, bytes);
+        MemoryPressure::release(bytes, true);
+    }
+};
+
+#endif // MEMORY_PRESSURE_H
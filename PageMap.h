@@ -0,0 +1,134 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/mman.h>
+
+// Three-level radix tree from page numbers to T*, covering every page of
+// an AddressBits-wide address space.
+//
+// The page number is split into root, interior and leaf indexes. The root
+// is part of the map; interior nodes and leaves are mapped on first use by
+// ensure(), so memory follows the address ranges actually registered. A
+// get() is three dependent loads with no lock and no branch on how many
+// ranges exist. Readers may run concurrently with ensure() and set(), which
+// must be serialized by the caller. Nodes are kept until the map is
+// destroyed.
+//
+//   PageMap<Span, 13> map;                  // 8 KB pages, 48-bit addresses
+//   map.ensure(firstPage, pages);           // under the owner's lock
+//   map.set(page, span);
+//   Span* span = map.get(address >> 13);    // from any thread
+template <class T, size_t PageShift, size_t AddressBits = 48>
+class PageMap {
+private:
+    static const size_t KEY_BITS = AddressBits - PageShift;
+    static const size_t LEAF_BITS = KEY_BITS / 3;
+    static const size_t INTERIOR_BITS = (KEY_BITS + 1) / 3;
+    static const size_t ROOT_BITS = KEY_BITS - LEAF_BITS - INTERIOR_BITS;
+    static const size_t LEAF_LENGTH = size_t(1) << LEAF_BITS;
+    static const size_t INTERIOR_LENGTH = size_t(1) << INTERIOR_BITS;
+    static const size_t ROOT_LENGTH = size_t(1) << ROOT_BITS;
+
+    struct Leaf {
+        T* values[LEAF_LENGTH];
+    };
+    struct Interior {
+        Leaf* leaves[INTERIOR_LENGTH];
+    };
+
+    Interior* root[ROOT_LENGTH];
+    size_t nodeBytes;
+
+    // Zeroed pages straight from the OS, so a new node reads as empty
+    template <class Node>
+    static Node* newNode() {
+        void* memory = mmap(nullptr, sizeof(Node), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return memory == MAP_FAILED ? nullptr : static_cast<Node*>(memory);
+    }
+
+public:
+    PageMap()
+        : root()
+        , nodeBytes(0) {
+    }
+
+    ~PageMap() {
+        for (Interior* interior : root) {
+            if (!interior) {
+                continue;
+            }
+            for (Leaf* leaf : interior->leaves) {
+                if (leaf) {
+                    munmap(leaf, sizeof(Leaf));
+                }
+            }
+            munmap(interior, sizeof(Interior));
+        }
+    }
+
+    PageMap(const PageMap&) = delete;
+    PageMap& operator=(const PageMap&) = delete;
+
+    // nullptr for pages never set or outside the address space
+    T* get(uintptr_t page) const {
+        if ((page >> KEY_BITS) != 0) {
+            return nullptr;
+        }
+        Interior* interior = __atomic_load_n(&root[page >> (LEAF_BITS + INTERIOR_BITS)], __ATOMIC_ACQUIRE);
+        if (!interior) {
+            return nullptr;
+        }
+        Leaf* leaf = __atomic_load_n(&interior->leaves[(page >> LEAF_BITS) & (INTERIOR_LENGTH - 1)], __ATOMIC_ACQUIRE);
+        if (!leaf) {
+            return nullptr;
+        }
+        return __atomic_load_n(&leaf->values[page & (LEAF_LENGTH - 1)], __ATOMIC_ACQUIRE);
+    }
+
+    // Map the nodes covering [page, page + count). Nodes are published
+    // only once zeroed, so concurrent readers see null, never garbage.
+    // False if the range leaves the address space or a node cannot be mapped.
+    bool ensure(uintptr_t page, size_t count) {
+        if (count == 0 || (page >> KEY_BITS) != 0 || ((page + count - 1) >> KEY_BITS) != 0) {
+            return count == 0;
+        }
+        for (uintptr_t key = page; key < page + count; key = ((key >> LEAF_BITS) + 1) << LEAF_BITS) {
+            Interior*& interior = root[key >> (LEAF_BITS + INTERIOR_BITS)];
+            if (!interior) {
+                Interior* node = newNode<Interior>();
+                if (!node) {
+                    return false;
+                }
+                nodeBytes += sizeof(Interior);
+                __atomic_store_n(&interior, node, __ATOMIC_RELEASE);
+            }
+            Leaf*& leaf = interior->leaves[(key >> LEAF_BITS) & (INTERIOR_LENGTH - 1)];
+            if (!leaf) {
+                Leaf* node = newNode<Leaf>();
+                if (!node) {
+                    return false;
+                }
+                nodeBytes += sizeof(Leaf);
+                __atomic_store_n(&leaf, node, __ATOMIC_RELEASE);
+            }
+        }
+        return true;
+    }
+
+    // page must be covered by a successful ensure()
+    void set(uintptr_t page, T* value) {
+        Interior* interior = root[page >> (LEAF_BITS + INTERIOR_BITS)];
+        Leaf* leaf = interior->leaves[(page >> LEAF_BITS) & (INTERIOR_LENGTH - 1)];
+        __atomic_store_n(&leaf->values[page & (LEAF_LENGTH - 1)], value, __ATOMIC_RELEASE);
+    }
+
+    // Interior nodes and leaves mapped so far; the root is sizeof(PageMap)
+    size_t getNodeBytes() const { return nodeBytes; }
+
+    // Pages one leaf covers
+    static size_t getLeafPages() { return LEAF_LENGTH; }
+};
+
+#endif // PAGE_MAP_H
@@ -0,0 +1,397 @@
+#include "PoolRegistry.h"
+#include "MemoryPool.h"
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Fixed slots so the signal-safe dump can walk them without locking. The
+// dump never dereferences pool, which may be mid-destruction; it prints
+// the copies below, refreshed under registryMutex by refreshSlot().
+struct Slot {
+    std::atomic<MemoryPool*> pool;
+    char name[PoolRegistry::MAX_NAME];
+    std::atomic<size_t> blockSize;
+    std::atomic<size_t> totalBlocks;
+    std::atomic<size_t> usedBlocks;
+    std::atomic<bool> threadSafe;
+};
+
+Slot slots[PoolRegistry::MAX_POOLS];
+std::mutex registryMutex;
+std::atomic<int> dumpFd(2);
+
+std::thread controlThread;
+std::atomic<bool> controlRunning(false);
+int controlSocket = -1;
+std::string controlPath;
+
+// Clients are served together from one poll() loop, so an idle one
+// delays neither the others nor stopControlSocket()
+const size_t MAX_CLIENTS = 16;
+const size_t MAX_LINE = 4096;           // Clients sending longer lines are dropped
+
+struct Client {
+    int fd;
+    std::string pending;                // Bytes after the last full line
+};
+
+// Signal-safe formatting helpers
+size_t appendText(char* buffer, size_t used, size_t capacity, const char* text) {
+    while (*text && used < capacity) {
+        buffer[used++] = *text++;
+    }
+    return used;
+}
+
+size_t appendNumber(char* buffer, size_t used, size_t capacity, size_t value) {
+    char digits[24];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0 && used < capacity) {
+        buffer[used++] = digits[--count];
+    }
+    return used;
+}
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void dumpSignalHandler(int) {
+    PoolRegistry::dumpToFd(dumpFd.load(std::memory_order_relaxed));
+}
+
+bool matches(const Slot& slot, const std::string& name) {
+    return name == "*" || name == slot.name;
+}
+
+// registryMutex held. Pools without a lock are only ever read by their
+// own thread, so their usage is not sampled here.
+void refreshSlot(Slot& slot, MemoryPool* pool) {
+    if (slot.threadSafe.load(std::memory_order_relaxed)) {
+        slot.usedBlocks.store(pool->sampleUsedBlocks(), std::memory_order_relaxed);
+    }
+}
+
+void refreshSlots() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (Slot& slot : slots) {
+        if (MemoryPool* pool = slot.pool.load(std::memory_order_acquire)) {
+            refreshSlot(slot, pool);
+        }
+    }
+}
+
+// Client readable: run every complete line it sent. False once the client
+// hung up, failed or overflowed its line buffer.
+bool serveClient(Client& client) {
+    char buffer[512];
+    ssize_t received = read(client.fd, buffer, sizeof(buffer));
+    if (received <= 0) {
+        return false;
+    }
+    client.pending.append(buffer, static_cast<size_t>(received));
+    size_t newline;
+    while ((newline = client.pending.find('\n')) != std::string::npos) {
+        std::string reply = PoolRegistry::handleCommand(client.pending.substr(0, newline));
+        client.pending.erase(0, newline + 1);
+        writeAll(client.fd, reply.data(), reply.size());
+    }
+    return client.pending.size() <= MAX_LINE;
+}
+
+void controlLoop(int listener) {
+    std::vector<Client> clients;
+    std::vector<pollfd> ready;
+    while (controlRunning.load()) {
+        // Wake up periodically so stopControlSocket() never waits on a client
+        ready.assign(1, pollfd{ listener, POLLIN, 0 });
+        for (const Client& client : clients) {
+            ready.push_back(pollfd{ client.fd, POLLIN, 0 });
+        }
+        int events = poll(ready.data(), ready.size(), 100);
+        if (events == 0) {
+            // Idle tick: keep the signal-safe dump's copies recent
+            refreshSlots();
+        }
+        if (events <= 0) {
+            continue;
+        }
+        for (size_t i = clients.size(); i-- > 0;) {
+            if (ready[i + 1].revents != 0 && !serveClient(clients[i])) {
+                close(clients[i].fd);
+                clients.erase(clients.begin() + i);
+            }
+        }
+        if (ready[0].revents & POLLIN) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0 && clients.size() < MAX_CLIENTS) {
+                // A client that stops reading cannot stall the loop for long
+                timeval timeout = { 1, 0 };
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                clients.push_back(Client{ fd, std::string() });
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+    for (const Client& client : clients) {
+        close(client.fd);
+    }
+}
+
+} // namespace
+
+bool PoolRegistry::add(MemoryPool* pool, const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (Slot& slot : slots) {
+        if (slot.pool.load(std::memory_order_relaxed) == nullptr) {
+            std::strncpy(slot.name, name.c_str(), MAX_NAME - 1);
+            slot.name[MAX_NAME - 1] = '\0';
+            // Called at the end of the pool's constructor, on its own thread
+            slot.blockSize.store(pool->getBlockSize(), std::memory_order_relaxed);
+            slot.totalBlocks.store(pool->getTotalBlocks(), std::memory_order_relaxed);
+            slot.usedBlocks.store(pool->getUsedBlocks(), std::memory_order_relaxed);
+            slot.threadSafe.store(pool->isThreadSafe(), std::memory_order_relaxed);
+            slot.pool.store(pool, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolRegistry::remove(MemoryPool* pool) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (Slot& slot : slots) {
+        if (slot.pool.load(std::memory_order_relaxed) == pool) {
+            slot.pool.store(nullptr, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+std::vector<PoolInfo> PoolRegistry::list() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<PoolInfo> pools;
+    for (Slot& slot : slots) {
+        MemoryPool* pool = slot.pool.load(std::memory_order_acquire);
+        if (!pool) {
+            continue;
+        }
+        refreshSlot(slot, pool);
+        PoolInfo info;
+        info.name = slot.name;
+        info.blockSize = slot.blockSize.load(std::memory_order_relaxed);
+        info.totalBlocks = slot.totalBlocks.load(std::memory_order_relaxed);
+        info.threadSafe = slot.threadSafe.load(std::memory_order_relaxed);
+        info.usedBlocks = info.threadSafe ? slot.usedBlocks.load(std::memory_order_relaxed) : 0;
+        info.quarantinedBlocks = info.threadSafe ? pool->getQuarantineStats().held : 0;
+        pools.push_back(info);
+    }
+    return pools;
+}
+
+bool PoolRegistry::trim(const std::string& name, size_t* releasedBytes, size_t* refused) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    bool found = false;
+    size_t released = 0;
+    size_t unsafe = 0;
+    for (Slot& slot : slots) {
+        MemoryPool* pool = slot.pool.load(std::memory_order_acquire);
+        if (!pool || !matches(slot, name)) {
+            continue;
+        }
+        if (!pool->isThreadSafe()) {
+            ++unsafe;
+            continue;
+        }
+        released += pool->trim();
+        refreshSlot(slot, pool);
+        found = true;
+    }
+    if (releasedBytes) {
+        *releasedBytes = released;
+    }
+    if (refused) {
+        *refused = unsafe;
+    }
+    return found;
+}
+
+bool PoolRegistry::setTunable(const std::string& name, const std::string& key, size_t value, size_t* refused) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    bool applied = false;
+    size_t unsafe = 0;
+    for (Slot& slot : slots) {
+        MemoryPool* pool = slot.pool.load(std::memory_order_acquire);
+        if (!pool || !matches(slot, name)) {
+            continue;
+        }
+        if (!pool->isThreadSafe()) {
+            ++unsafe;
+        } else if (pool->setTunable(key, value)) {
+            refreshSlot(slot, pool);
+            applied = true;
+        }
+    }
+    if (refused) {
+        *refused = unsafe;
+    }
+    return applied;
+}
+
+void PoolRegistry::dumpToFd(int fd) {
+    char line[256];
+    for (Slot& slot : slots) {
+        if (!slot.pool.load(std::memory_order_acquire)) {
+            continue;
+        }
+        size_t used = 0;
+        used = appendText(line, used, sizeof(line), slot.name);
+        used = appendText(line, used, sizeof(line), " block=");
+        used = appendNumber(line, used, sizeof(line), slot.blockSize.load(std::memory_order_relaxed));
+        used = appendText(line, used, sizeof(line), " total=");
+        used = appendNumber(line, used, sizeof(line), slot.totalBlocks.load(std::memory_order_relaxed));
+        if (slot.threadSafe.load(std::memory_order_relaxed)) {
+            used = appendText(line, used, sizeof(line), " used=");
+            used = appendNumber(line, used, sizeof(line), slot.usedBlocks.load(std::memory_order_relaxed));
+        } else {
+            used = appendText(line, used, sizeof(line), " not-thread-safe");
+        }
+        used = appendText(line, used, sizeof(line), "\n");
+        writeAll(fd, line, used);
+    }
+}
+
+bool PoolRegistry::installDumpSignal(int signo, int fd) {
+    dumpFd.store(fd);
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = dumpSignalHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(signo, &action, nullptr) == 0;
+}
+
+bool PoolRegistry::startControlSocket(const std::string& path) {
+    if (controlRunning.load()) {
+        return false;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        return false;
+    }
+    // Replace a stale socket, but never delete anything else at path
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            close(listener);
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listener, 4) != 0) {
+        close(listener);
+        return false;
+    }
+
+    controlSocket = listener;
+    controlPath = path;
+    controlRunning.store(true);
+    controlThread = std::thread(controlLoop, listener);
+    return true;
+}
+
+void PoolRegistry::stopControlSocket() {
+    if (!controlRunning.exchange(false)) {
+        return;
+    }
+    controlThread.join();
+    close(controlSocket);
+    unlink(controlPath.c_str());
+    controlSocket = -1;
+}
+
+std::string PoolRegistry::handleCommand(const std::string& line) {
+    std::istringstream in(line);
+    std::string command, name, key;
+    in >> command;
+    std::ostringstream reply;
+
+    if (command == "list") {
+        for (const PoolInfo& info : list()) {
+            reply << info.name << " block=" << info.blockSize << " total=" << info.totalBlocks;
+            if (info.threadSafe) {
+                reply << " used=" << info.usedBlocks << " quarantined=" << info.quarantinedBlocks << "\n";
+            } else {
+                reply << " not-thread-safe\n";
+            }
+        }
+        reply << "end\n";
+    } else if (command == "trim" && (in >> name)) {
+        size_t released = 0;
+        size_t refused = 0;
+        if (trim(name, &released, &refused)) {
+            reply << "released " << released;
+            if (refused > 0) {
+                reply << " (" << refused << " pools not thread-safe, skipped)";
+            }
+            reply << "\n";
+        } else if (refused > 0) {
+            reply << "error: " << name << " is not thread-safe\n";
+        } else {
+            reply << "error: no pool " << name << "\n";
+        }
+    } else if (command == "set") {
+        size_t value;
+        size_t refused = 0;
+        if (!(in >> name >> key >> value)) {
+            reply << "error: usage set <name|*> <key> <value>\n";
+        } else if (setTunable(name, key, value, &refused)) {
+            reply << "ok";
+            if (refused > 0) {
+                reply << " (" << refused << " pools not thread-safe, skipped)";
+            }
+            reply << "\n";
+        } else if (refused > 0) {
+            reply << "error: " << name << " is not thread-safe\n";
+        } else {
+            reply << "error: no pool " << name << " accepts " << key << "=" << value << "\n";
+        }
+    } else {
+        reply << "error: unknown command\n";
+    }
+    return reply.str();
+}
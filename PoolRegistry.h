@@ -0,0 +1,67 @@
+#ifndef POOL_REGISTRY_H
+#define POOL_REGISTRY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class MemoryPool;
+
+struct PoolInfo {
+    std::string name;
+    size_t blockSize;
+    size_t totalBlocks;
+    size_t usedBlocks;              // 0 unless threadSafe
+    size_t quarantinedBlocks;       // 0 unless threadSafe
+    bool threadSafe;                // Usage is only read from pools that lock
+};
+
+// Process-wide directory of named pools.
+//
+// A pool joins by setting PoolOptions::name and leaves in its destructor.
+// Operations by name hold the registry lock, so a pool cannot be destroyed
+// while it is being trimmed or tuned. They run on the caller's thread (the
+// control socket's, for remote commands), so pools that are not thread-safe
+// are never trimmed or tuned through the registry, and list() reports only
+// their geometry. dumpToFd() takes no locks and is safe to call from a
+// signal handler. It never touches the pools: it prints usage copied into
+// the registry by list(), trim(), set and, while the control socket runs,
+// every idle 100 ms.
+//
+// The control socket speaks a line protocol, one reply per command:
+//   list                       -> one line per pool
+//   trim <name|*>              -> bytes released
+//   set <name|*> <key> <value> -> ok / error
+// Up to 16 clients are served at once from a single thread.
+class PoolRegistry {
+public:
+    static const size_t MAX_POOLS = 256;
+    static const size_t MAX_NAME = 64;      // Longer names are truncated
+
+    // Called by MemoryPool; false when the registry is full
+    static bool add(MemoryPool* pool, const std::string& name);
+    static void remove(MemoryPool* pool);
+
+    static std::vector<PoolInfo> list();
+
+    // "*" addresses every registered pool. Both return false if no pool was
+    // trimmed or accepted the setting; refused counts matching pools skipped
+    // because they are not thread-safe.
+    static bool trim(const std::string& name, size_t* releasedBytes = nullptr, size_t* refused = nullptr);
+    static bool setTunable(const std::string& name, const std::string& key, size_t value,
+                           size_t* refused = nullptr);
+
+    // Async-signal-safe: formats with write(2) only, no allocation or locks
+    static void dumpToFd(int fd);
+    static bool installDumpSignal(int signo, int fd = 2);
+
+    // Serve the line protocol on a Unix socket from a background thread
+    // Fails if path exists and is not a socket
+    static bool startControlSocket(const std::string& path);
+    static void stopControlSocket();
+
+    // Run one protocol command and return its reply (used by the socket)
+    static std::string handleCommand(const std::string& line);
+};
+
+#endif // POOL_REGISTRY_H
@@ -0,0 +1,147 @@
+#include "PoolSnapshot.h"
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+static const char SNAPSHOT_MAGIC[4] = { 'M', 'P', 'S', 'N' };
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+// Fixed-width little-endian encoding, independent of host byte order
+static void putLE(std::ostream& out, uint64_t value, size_t bytes) {
+    char buffer[8];
+    for (size_t i = 0; i < bytes; ++i) {
+        buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out.write(buffer, static_cast<std::streamsize>(bytes));
+}
+
+static bool getLE(std::istream& in, uint64_t& value, size_t bytes) {
+    unsigned char buffer[8];
+    if (!in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(bytes))) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+    }
+    return true;
+}
+
+size_t PoolSnapshot::blocksInPage(size_t page) const {
+    // Blocks whose first byte lies in [page * pageSize, (page + 1) * pageSize)
+    size_t pageBegin = page * pageSize;
+    size_t pageEnd = pageBegin + pageSize;
+    size_t poolEnd = firstBlockOffset + totalBlocks * blockSize;
+    if (pageEnd > poolEnd) {
+        pageEnd = poolEnd;
+    }
+    if (pageBegin < firstBlockOffset) {
+        pageBegin = firstBlockOffset;
+    }
+    if (pageBegin >= pageEnd) {
+        return 0;
+    }
+    size_t first = (pageBegin - firstBlockOffset + blockSize - 1) / blockSize;
+    size_t last = (pageEnd - firstBlockOffset + blockSize - 1) / blockSize;
+    return last - first;
+}
+
+double PoolSnapshot::utilization() const {
+    return totalBlocks ? static_cast<double>(liveBlocks) / totalBlocks : 0.0;
+}
+
+size_t PoolSnapshot::alignmentWasteBytes() const {
+    return liveBlocks * (blockSize - requestedSize);
+}
+
+void PoolSnapshot::writeJson(std::ostream& out) const {
+    out << "{\"requestedSize\":" << requestedSize
+        << ",\"blockSize\":" << blockSize
+        << ",\"totalBlocks\":" << totalBlocks
+        << ",\"liveBlocks\":" << liveBlocks
+        << ",\"quarantinedBlocks\":" << quarantinedBlocks
+        << ",\"utilization\":" << utilization()
+        << ",\"alignmentWasteBytes\":" << alignmentWasteBytes()
+        << ",\"pageSize\":" << pageSize
+        << ",\"pages\":[";
+    for (size_t i = 0; i < pageLiveBlocks.size(); ++i) {
+        out << (i ? "," : "") << "{\"page\":" << i
+            << ",\"blocks\":" << blocksInPage(i)
+            << ",\"live\":" << pageLiveBlocks[i] << "}";
+    }
+    out << "]}";
+}
+
+void PoolSnapshot::writeBinary(std::ostream& out) const {
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    putLE(out, SNAPSHOT_VERSION, 4);
+    putLE(out, requestedSize, 8);
+    putLE(out, blockSize, 8);
+    putLE(out, totalBlocks, 8);
+    putLE(out, liveBlocks, 8);
+    putLE(out, quarantinedBlocks, 8);
+    putLE(out, pageSize, 8);
+    putLE(out, firstBlockOffset, 8);
+    putLE(out, pageLiveBlocks.size(), 8);
+    for (uint16_t live : pageLiveBlocks) {
+        putLE(out, live, 2);
+    }
+}
+
+bool PoolSnapshot::readBinary(std::istream& in, PoolSnapshot& snapshot) {
+    char magic[4];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    uint64_t version, pageCount;
+    uint64_t fields[7];
+    if (!getLE(in, version, 4) || version != SNAPSHOT_VERSION) {
+        return false;
+    }
+    for (uint64_t& field : fields) {
+        if (!getLE(in, field, 8)) {
+            return false;
+        }
+    }
+    if (!getLE(in, pageCount, 8)) {
+        return false;
+    }
+
+    // The page count follows from the geometry; anything else is a corrupt
+    // or hostile file, and is refused before it sizes an allocation
+    uint64_t blockSize = fields[1], totalBlocks = fields[2], pageSize = fields[5], offset = fields[6];
+    if (blockSize == 0 || pageSize == 0 || offset >= pageSize
+        || totalBlocks > (UINT64_MAX - offset) / blockSize
+        || offset + totalBlocks * blockSize > UINT64_MAX - (pageSize - 1)
+        || pageCount != (offset + totalBlocks * blockSize + pageSize - 1) / pageSize) {
+        return false;
+    }
+
+    // A seekable stream must also hold every entry
+    std::streampos here = in.tellg();
+    if (here != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+        std::streamoff remaining = in.tellg() - here;
+        in.seekg(here);
+        if (remaining < 0 || static_cast<uint64_t>(remaining) / 2 < pageCount) {
+            return false;
+        }
+    }
+    in.clear();
+
+    snapshot.requestedSize = fields[0];
+    snapshot.blockSize = blockSize;
+    snapshot.totalBlocks = totalBlocks;
+    snapshot.liveBlocks = fields[3];
+    snapshot.quarantinedBlocks = fields[4];
+    snapshot.pageSize = pageSize;
+    snapshot.firstBlockOffset = offset;
+    snapshot.pageLiveBlocks.clear();
+    for (uint64_t i = 0; i < pageCount; ++i) {
+        uint64_t value;
+        if (!getLE(in, value, 2)) {
+            return false;
+        }
+        snapshot.pageLiveBlocks.push_back(static_cast<uint16_t>(value));
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef POOL_SNAPSHOT_H
+#define POOL_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Point-in-time occupancy map of a pool, for diagnosing fragmentation.
+//
+// A block is attributed to the OS page holding its first byte, so
+// pageLiveBlocks[i] counts the live blocks that start in page i of the pool.
+// The pool lock is only held while its per-page counts are copied (with
+// PoolOptions::trackOccupancy) or, a bounded batch at a time, while free
+// blocks are marked in a bitmap; all counting and formatting happens after
+// it is released. Covers MemoryPool only; the small-object allocator's
+// spans and AlignedChunkPool's chunks have no snapshot.
+struct PoolSnapshot {
+    size_t requestedSize;           // Block size the pool was created with
+    size_t blockSize;               // Block size after alignSize() rounding
+    size_t totalBlocks;
+    size_t liveBlocks;
+    size_t quarantinedBlocks;       // Freed but not yet reusable
+    size_t pageSize;
+    size_t firstBlockOffset;        // Offset of block 0 within page 0
+    std::vector<uint16_t> pageLiveBlocks;
+
+    // Blocks starting in page i, live or not
+    size_t blocksInPage(size_t page) const;
+
+    // Live blocks / total blocks
+    double utilization() const;
+
+    // Bytes lost to alignSize() rounding across live blocks
+    size_t alignmentWasteBytes() const;
+
+    // Human- and tool-readable dump, one object per pool
+    void writeJson(std::ostream& out) const;
+
+    // Compact little-endian dump: "MPSN" magic, version, header fields as
+    // u64, page count as u64, then one u16 live count per page
+    void writeBinary(std::ostream& out) const;
+
+    // False for a bad header, a page count that does not match the header's
+    // geometry, or a truncated page table
+    static bool readBinary(std::istream& in, PoolSnapshot& snapshot);
+};
+
+#endif // POOL_SNAPSHOT_H
@@ -0,0 +1,561 @@
+#include "SmallObjectAllocator.h"
+#include "BasicPool.h"
+#include "BlockLinker.h"
+#include "HeapProfiler.h"
+#include "MemoryPressure.h"
+#include "PageMap.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+
+namespace {
+
+const size_t PAGE_SHIFT = 13;                           // The page heap works in 8 KB pages
+const size_t PAGE_BYTES = size_t(1) << PAGE_SHIFT;
+const size_t REGION_BYTES = 64 * 1024 * 1024;           // Address space mapped at a time
+const size_t MAX_REGIONS = 4096;
+const size_t MAX_LISTED_PAGES = 128;                    // Longer free spans share one list
+const size_t TRANSFER_SLOTS = 64;                       // Whole batches held per central list
+const size_t NUM_CLASSES = 41;
+
+// Class 0 means "not a small object". 16-byte steps up to 128, then four
+// classes per power of two, so rounding never wastes more than 25%.
+const uint32_t CLASS_SIZES[NUM_CLASSES] = {
+    0, 16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192,
+    10240, 12288, 14336, 16384, 20480, 24576, 28672, 32768
+};
+
+// Size class for 0 < size <= MAX_SMALL_SIZE, without a lookup table
+inline size_t classIndex(size_t size) {
+    if (size <= 128) {
+        return size == 0 ? 1 : (size + 15) >> 4;
+    }
+    size_t shift = 63 - __builtin_clzll(size - 1);      // 2^shift < size <= 2^(shift + 1)
+    size_t quarterShift = shift - 2;
+    return 8 + 4 * (shift - 7) + ((size - (size_t(1) << shift) + (size_t(1) << quarterShift) - 1) >> quarterShift);
+}
+
+// Objects moved between a thread cache and its central list at a time
+size_t batchSize(size_t sizeClass) {
+    size_t objects = 64 * 1024 / CLASS_SIZES[sizeClass];
+    return objects < 2 ? 2 : (objects > 32 ? 32 : objects);
+}
+
+// Pages per span: room for at least four objects, at most 1/8 left over
+size_t spanPages(size_t sizeClass) {
+    size_t size = CLASS_SIZES[sizeClass];
+    size_t pages = (4 * size + PAGE_BYTES - 1) / PAGE_BYTES;
+    while ((pages * PAGE_BYTES) % size > pages * PAGE_BYTES / 8) {
+        ++pages;
+    }
+    return pages;
+}
+
+inline void*& nextOf(void* object) {
+    return *static_cast<void**>(object);
+}
+
+// ---- Page heap ----
+
+struct Span {
+    uintptr_t firstPage;            // Address >> PAGE_SHIFT
+    size_t pages;
+    size_t region;                  // Spans never cross regions
+    size_t sizeClass;               // 0 for large allocations and free spans
+    void* freeObjects;              // Small-object spans only
+    size_t liveObjects;
+    uint32_t sampled;               // Live profiler samples, by __atomic builtins
+    Span* prev;                     // In a central nonempty list or a free list
+    Span* next;
+    bool free;
+    bool released;                  // Free and handed back to the OS
+};
+
+void listPush(Span*& head, Span* span) {
+    span->prev = nullptr;
+    span->next = head;
+    if (head) {
+        head->prev = span;
+    }
+    head = span;
+}
+
+void listRemove(Span*& head, Span* span) {
+    if (span->prev) {
+        span->prev->next = span->next;
+    } else {
+        head = span->next;
+    }
+    if (span->next) {
+        span->next->prev = span->prev;
+    }
+    span->prev = span->next = nullptr;
+}
+
+// Page-to-span map over the whole address space. In-use spans map every
+// page, so any object finds its span; free spans map their first and last
+// page, which is all coalescing needs, and leave their interior pages null
+// so a stray pointer never reaches a freed or reused span record. Written
+// under the page heap lock, read without one. Never destroyed, like the
+// page heap.
+typedef PageMap<Span, PAGE_SHIFT> SpanMap;
+
+SpanMap& spanMap() {
+    static SpanMap* map = new SpanMap();
+    return *map;
+}
+
+inline Span* spanOf(const void* ptr) {
+    return spanMap().get(reinterpret_cast<uintptr_t>(ptr) >> PAGE_SHIFT);
+}
+
+struct SpanPoolConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef MmapBacking BackingPolicy;
+};
+
+class PageHeap {
+private:
+    std::mutex mutex;
+    Span* freeLists[MAX_LISTED_PAGES + 1];  // Indexed by span length
+    Span* largeFree;                        // Free spans longer than MAX_LISTED_PAGES
+    size_t regionCount;                     // Regions mapped; spans never cross one
+    BasicPool<SpanPoolConfig> spanPool;     // Span metadata, under the heap lock
+    SmallObjectStats stats;
+
+    void setMap(Span* span, uintptr_t page) {
+        spanMap().set(page, span);
+    }
+
+    Span* newSpan(uintptr_t firstPage, size_t pages, size_t region) {
+        Span* span = static_cast<Span*>(spanPool.allocate());
+        span->firstPage = firstPage;
+        span->pages = pages;
+        span->region = region;
+        span->sizeClass = 0;
+        span->freeObjects = nullptr;
+        span->liveObjects = 0;
+        span->sampled = 0;
+        span->prev = span->next = nullptr;
+        span->free = false;
+        span->released = false;
+        return span;
+    }
+
+    Span*& freeListFor(size_t pages) {
+        return pages <= MAX_LISTED_PAGES ? freeLists[pages] : largeFree;
+    }
+
+    void insertFree(Span* span) {
+        span->free = true;
+        span->sizeClass = 0;
+        setMap(span, span->firstPage);
+        setMap(span, span->firstPage + span->pages - 1);
+        listPush(freeListFor(span->pages), span);
+        (span->released ? stats.releasedBytes : stats.freeBytes) += span->pages * PAGE_BYTES;
+    }
+
+    void removeFree(Span* span) {
+        listRemove(freeListFor(span->pages), span);
+        (span->released ? stats.releasedBytes : stats.freeBytes) -= span->pages * PAGE_BYTES;
+        span->free = false;
+    }
+
+    // First fit by length, then best fit among the long spans
+    Span* findFree(size_t pages) {
+        for (size_t length = pages; length <= MAX_LISTED_PAGES; ++length) {
+            if (freeLists[length]) {
+                return freeLists[length];
+            }
+        }
+        Span* best = nullptr;
+        for (Span* span = largeFree; span; span = span->next) {
+            if (span->pages >= pages && (!best || span->pages < best->pages)) {
+                best = span;
+            }
+        }
+        return best;
+    }
+
+    // Map a new region, 8 KB aligned, as one free span
+    bool grow(size_t pages) {
+        size_t index = regionCount;
+        size_t bytes = pages * PAGE_BYTES > REGION_BYTES ? pages * PAGE_BYTES : REGION_BYTES;
+        // Regions are never unmapped, so a granted reservation is kept
+        if (index == MAX_REGIONS || !MemoryPressure::reserve(bytes, true)) {
+            return false;
+        }
+        void* mapped = mmap(nullptr, bytes + PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            MemoryPressure::release(bytes, true);
+            return false;
+        }
+        uintptr_t raw = reinterpret_cast<uintptr_t>(mapped);
+        uintptr_t start = (raw + PAGE_BYTES - 1) & ~(PAGE_BYTES - 1);
+        if (start > raw) {
+            munmap(mapped, start - raw);
+        }
+        munmap(reinterpret_cast<void*>(start + bytes), raw + PAGE_BYTES - start);
+
+        if (!spanMap().ensure(start >> PAGE_SHIFT, bytes / PAGE_BYTES)) {
+            munmap(reinterpret_cast<void*>(start), bytes);
+            MemoryPressure::release(bytes, true);
+            return false;
+        }
+        regionCount = index + 1;
+
+        stats.mappedBytes += bytes;
+        insertFree(newSpan(start >> PAGE_SHIFT, bytes / PAGE_BYTES, index));
+        return true;
+    }
+
+public:
+    PageHeap()
+        : freeLists()
+        , largeFree(nullptr)
+        , regionCount(0)
+        , spanPool(sizeof(Span), PAGE_BYTES / sizeof(Span))
+        , stats() {
+    }
+
+    Span* allocate(size_t pages, size_t sizeClass) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Span* span = findFree(pages);
+        if (!span) {
+            if (!grow(pages)) {
+                return nullptr;
+            }
+            span = findFree(pages);
+        }
+        removeFree(span);
+        if (span->pages > pages) {
+            Span* rest = newSpan(span->firstPage + pages, span->pages - pages, span->region);
+            rest->released = span->released;
+            span->pages = pages;
+            insertFree(rest);
+        }
+        span->released = false;
+        span->sizeClass = sizeClass;
+        for (size_t i = 0; i < pages; ++i) {
+            setMap(span, span->firstPage + i);
+        }
+        stats.spanBytes += pages * PAGE_BYTES;
+        return span;
+    }
+
+    // Coalesce with free neighbours in the same region. A span merged with
+    // a released neighbour counts as resident until the next release().
+    void free(Span* span) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.spanBytes -= span->pages * PAGE_BYTES;
+        span->released = false;
+        for (size_t i = 0; i < span->pages; ++i) {
+            setMap(nullptr, span->firstPage + i);
+        }
+
+        // Adjacent regions may touch; spans still never cross them. A merged
+        // neighbour's inner end page becomes interior to the new span.
+        Span* before = spanMap().get(span->firstPage - 1);
+        if (before && before->free && before->region == span->region) {
+            removeFree(before);
+            setMap(nullptr, span->firstPage - 1);
+            span->firstPage = before->firstPage;
+            span->pages += before->pages;
+            spanPool.deallocate(before);
+        }
+        Span* after = spanMap().get(span->firstPage + span->pages);
+        if (after && after->free && after->region == span->region) {
+            removeFree(after);
+            setMap(nullptr, after->firstPage);
+            span->pages += after->pages;
+            spanPool.deallocate(after);
+        }
+        insertFree(span);
+    }
+
+    size_t release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t released = 0;
+        auto releaseList = [&](Span* span) {
+            for (; span; span = span->next) {
+                if (span->released) {
+                    continue;
+                }
+                size_t bytes = span->pages * PAGE_BYTES;
+                madvise(reinterpret_cast<void*>(span->firstPage << PAGE_SHIFT), bytes, MADV_DONTNEED);
+                span->released = true;
+                stats.freeBytes -= bytes;
+                stats.releasedBytes += bytes;
+                released += bytes;
+            }
+        };
+        for (Span* list : freeLists) {
+            releaseList(list);
+        }
+        releaseList(largeFree);
+        return released;
+    }
+
+    SmallObjectStats getStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+};
+
+// Never destroyed: threads may still free objects while the process exits
+PageHeap& pageHeap() {
+    static PageHeap* heap = new PageHeap();
+    return *heap;
+}
+
+// ---- Central lists ----
+
+struct alignas(64) CentralList {
+    std::mutex mutex;
+    Span* nonempty = nullptr;                   // Spans with free objects
+    void* batches[TRANSFER_SLOTS] = {};         // Chains of exactly batchSize() objects
+    size_t batchCount = 0;
+
+    // Caller holds mutex. Push each object back on its span; a span with
+    // no live objects left goes back to the page heap.
+    void returnToSpans(void* chain) {
+        while (chain) {
+            void* object = chain;
+            chain = nextOf(object);
+            Span* span = spanOf(object);
+            if (!span->freeObjects) {
+                listPush(nonempty, span);
+            }
+            nextOf(object) = span->freeObjects;
+            span->freeObjects = object;
+            if (--span->liveObjects == 0) {
+                listRemove(nonempty, span);
+                pageHeap().free(span);
+            }
+        }
+    }
+
+    // Up to count objects as a null-terminated chain; returns how many
+    size_t fetch(size_t sizeClass, size_t count, void** chain) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (batchCount > 0 && count == batchSize(sizeClass)) {
+            *chain = batches[--batchCount];
+            return count;
+        }
+
+        void* head = nullptr;
+        size_t fetched = 0;
+        while (fetched < count) {
+            if (!nonempty) {
+                Span* span = pageHeap().allocate(spanPages(sizeClass), sizeClass);
+                if (!span) {
+                    break;
+                }
+                size_t size = CLASS_SIZES[sizeClass];
+                char* start = reinterpret_cast<char*>(span->firstPage << PAGE_SHIFT);
+                linkBlocks(start, size, span->pages * PAGE_BYTES / size, nullptr);
+                span->freeObjects = start;
+                listPush(nonempty, span);
+            }
+            Span* span = nonempty;
+            while (fetched < count && span->freeObjects) {
+                void* object = span->freeObjects;
+                span->freeObjects = nextOf(object);
+                nextOf(object) = head;
+                head = object;
+                ++span->liveObjects;
+                ++fetched;
+            }
+            if (!span->freeObjects) {
+                listRemove(nonempty, span);
+            }
+        }
+        *chain = head;
+        return fetched;
+    }
+
+    // Whole batches are kept for the next fetch; anything else goes to spans
+    void release(size_t sizeClass, void* chain, size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == batchSize(sizeClass) && batchCount < TRANSFER_SLOTS) {
+            batches[batchCount++] = chain;
+            return;
+        }
+        returnToSpans(chain);
+    }
+
+    void drainBatches() {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (batchCount > 0) {
+            returnToSpans(batches[--batchCount]);
+        }
+    }
+};
+
+CentralList centralLists[NUM_CLASSES];
+
+// ---- Thread caches ----
+
+// Plain data, so the fast path needs no TLS initialization check
+struct CachedList {
+    void* head;
+    uint32_t length;
+    uint32_t maxLength;             // 0 until the list first goes to its central list
+};
+
+thread_local CachedList threadLists[NUM_CLASSES];
+
+// Flushes the thread's lists at exit; touched on slow paths to register
+struct ThreadCacheOwner {
+    bool registered = false;
+    ~ThreadCacheOwner() {
+        SmallObjectAllocator::flushThreadCache();
+    }
+};
+
+thread_local ThreadCacheOwner threadCacheOwner;
+
+// Live profiler samples in all spans, so a free only looks up its span
+// while some object is sampled
+std::atomic<size_t> profiledObjects(0);
+
+__attribute__((noinline)) void* allocateSlow(size_t sizeClass) {
+    threadCacheOwner.registered = true;
+    CachedList& list = threadLists[sizeClass];
+    size_t batch = batchSize(sizeClass);
+    if (list.maxLength == 0) {
+        list.maxLength = static_cast<uint32_t>(2 * batch);
+    }
+    void* chain;
+    size_t fetched = centralLists[sizeClass].fetch(sizeClass, batch, &chain);
+    if (fetched == 0) {
+        return nullptr;
+    }
+    list.head = nextOf(chain);
+    list.length = static_cast<uint32_t>(fetched - 1);
+    return chain;
+}
+
+// The list outgrew maxLength: hand one batch from its head to the central list
+__attribute__((noinline)) void releaseSlow(size_t sizeClass) {
+    threadCacheOwner.registered = true;
+    CachedList& list = threadLists[sizeClass];
+    size_t batch = batchSize(sizeClass);
+    if (list.maxLength == 0) {
+        list.maxLength = static_cast<uint32_t>(2 * batch);
+        if (list.length <= list.maxLength) {
+            return;
+        }
+    }
+    void* chain = list.head;
+    void* last = chain;
+    for (size_t i = 1; i < batch; ++i) {
+        last = nextOf(last);
+    }
+    list.head = nextOf(last);
+    nextOf(last) = nullptr;
+    list.length -= static_cast<uint32_t>(batch);
+    centralLists[sizeClass].release(sizeClass, chain, batch);
+}
+
+size_t largePages(size_t size) {
+    return (size + PAGE_BYTES - 1) >> PAGE_SHIFT;
+}
+
+void* allocateLarge(size_t size) {
+    Span* span = pageHeap().allocate(largePages(size), 0);
+    return span ? reinterpret_cast<void*>(span->firstPage << PAGE_SHIFT) : nullptr;
+}
+
+} // namespace
+
+void* SmallObjectAllocator::allocate(size_t size) {
+    void* ptr;
+    if (size > MAX_SMALL_SIZE) {
+        ptr = allocateLarge(size);
+    } else {
+        size_t sizeClass = classIndex(size);
+        CachedList& list = threadLists[sizeClass];
+        ptr = list.head;
+        if (ptr) {
+            list.head = nextOf(ptr);
+            --list.length;
+        } else {
+            ptr = allocateSlow(sizeClass);
+        }
+    }
+    if (ptr && HeapProfiler::isActive() && HeapProfiler::shouldSample(size)) {
+        __atomic_fetch_add(&spanOf(ptr)->sampled, 1, __ATOMIC_RELAXED);
+        HeapProfiler::recordAllocation(ptr, size);
+        profiledObjects.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+void SmallObjectAllocator::deallocate(void* ptr, size_t size) {
+    if (!ptr) {
+        return;
+    }
+    // The profiler's lock is only taken for objects in a sampled span
+    if (profiledObjects.load(std::memory_order_relaxed) != 0) {
+        Span* span = spanOf(ptr);
+        if (span && __atomic_load_n(&span->sampled, __ATOMIC_RELAXED) != 0
+            && HeapProfiler::recordDeallocation(ptr)) {
+            __atomic_fetch_sub(&span->sampled, 1, __ATOMIC_RELAXED);
+            profiledObjects.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    if (size > MAX_SMALL_SIZE) {
+        pageHeap().free(spanOf(ptr));
+        return;
+    }
+    size_t sizeClass = classIndex(size);
+    CachedList& list = threadLists[sizeClass];
+    nextOf(ptr) = list.head;
+    list.head = ptr;
+    if (++list.length > list.maxLength) {
+        releaseSlow(sizeClass);
+    }
+}
+
+void SmallObjectAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    Span* span = spanOf(ptr);
+    if (!span || span->free) {
+        throw std::invalid_argument("Pointer not from this allocator");
+    }
+    deallocate(ptr, span->sizeClass ? CLASS_SIZES[span->sizeClass] : span->pages * PAGE_BYTES);
+}
+
+size_t SmallObjectAllocator::getAllocatedSize(size_t size) {
+    return size > MAX_SMALL_SIZE ? largePages(size) * PAGE_BYTES : CLASS_SIZES[classIndex(size)];
+}
+
+void SmallObjectAllocator::flushThreadCache() {
+    for (size_t sizeClass = 1; sizeClass < NUM_CLASSES; ++sizeClass) {
+        CachedList& list = threadLists[sizeClass];
+        if (list.length > 0) {
+            centralLists[sizeClass].release(sizeClass, list.head, list.length);
+            list.head = nullptr;
+            list.length = 0;
+        }
+    }
+}
+
+size_t SmallObjectAllocator::releaseFreeMemory() {
+    for (size_t sizeClass = 1; sizeClass < NUM_CLASSES; ++sizeClass) {
+        centralLists[sizeClass].drainBatches();
+    }
+    return pageHeap().release();
+}
+
+SmallObjectStats SmallObjectAllocator::getStats() {
+    return pageHeap().getStats();
+}
@@ -0,0 +1,53 @@
+#ifndef SMALL_OBJECT_ALLOCATOR_H
+#define SMALL_OBJECT_ALLOCATOR_H
+
+#include <cstddef>
+
+struct SmallObjectStats {
+    size_t mappedBytes;             // Address space taken from the OS
+    size_t spanBytes;               // Handed to size classes or large allocations
+    size_t freeBytes;               // In free spans, still resident
+    size_t releasedBytes;           // In free spans given back with releaseFreeMemory()
+};
+
+// Process-wide allocator for mixed-size small objects, in three tiers:
+//
+//   thread cache  per-thread free list per size class; no locks
+//   central list  per size class, one lock each; moves objects to and from
+//                 thread caches a batch at a time, keeps whole batches ready
+//                 for the next thread, and carves spans into objects
+//   page heap     one lock; carves 8 KB-page spans out of 64 MB regions,
+//                 coalesces freed spans with their free neighbours
+//
+// A span whose objects have all come back is returned to the page heap, so
+// memory freed in one size class can be reused by another. Requests over
+// MAX_SMALL_SIZE bypass the caches and get a span of their own.
+class SmallObjectAllocator {
+public:
+    static const size_t MAX_SMALL_SIZE = 32 * 1024;
+
+    // 16-byte aligned; nullptr when the address space is exhausted
+    static void* allocate(size_t size);
+
+    // size must be the value passed to allocate(); this is the fast path
+    static void deallocate(void* ptr, size_t size);
+
+    // Looks the size up from the pointer's span; throws std::invalid_argument
+    // for pointers this allocator did not return
+    static void deallocate(void* ptr);
+
+    // Usable size of an allocation of the given size
+    static size_t getAllocatedSize(size_t size);
+
+    // Return the calling thread's cached objects to the central lists.
+    // Threads do this automatically when they exit.
+    static void flushThreadCache();
+
+    // Return batches held by the central lists to their spans, then give
+    // every free span's pages back to the OS. Returns the bytes released.
+    static size_t releaseFreeMemory();
+
+    static SmallObjectStats getStats();
+};
+
+#endif // SMALL_OBJECT_ALLOCATOR_H
@@ -0,0 +1,92 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Bounded single-producer, single-consumer queue.
+//
+// One thread may push() and one other thread may pop(). Each side owns one
+// index, on its own cache line, and keeps a copy of the other side's index
+// that it refreshes only when the ring looks full or empty. So a push or
+// pop normally reads and writes only lines its own thread owns, plus the
+// element itself.
+template <class T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity)
+        : mask(roundUp(capacity) - 1)
+        , slots(mask + 1)
+        , head(0)
+        , cachedTail(0)
+        , tail(0)
+        , cachedHead(0) {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only; false when full
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; false when empty
+    bool pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact from either side when the other is idle, a snapshot otherwise
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Ring capacity must be greater than 0");
+        }
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const size_t mask;
+    std::vector<T> slots;
+
+    // Consumer line: its index and its view of the producer's
+    alignas(64) std::atomic<size_t> head;
+    size_t cachedTail;
+
+    // Producer line
+    alignas(64) std::atomic<size_t> tail;
+    size_t cachedHead;
+    char padding[64 - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+#endif // SPSC_RING_H
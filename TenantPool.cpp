@@ -0,0 +1,135 @@
+#include "TenantPool.h"
+#include "MemoryPool.h"
+#include <stdexcept>
+
+namespace {
+
+// Tenant::held packs reserved blocks in the low 32 bits, shared above
+const uint64_t SHARED_ONE = uint64_t(1) << 32;
+const uint64_t RESERVED_MASK = SHARED_ONE - 1;
+
+} // namespace
+
+TenantPool::Tenant::Tenant(TenantPool& owner, size_t quota, size_t reserved)
+    : owner(owner)
+    , quota(quota)
+    , reserved(reserved)
+    , held(0)
+    , quotaFailures(0)
+    , sharedFailures(0) {
+}
+
+void* TenantPool::Tenant::allocate() {
+    // Claim a reserved block while any is left, else a shared one. The
+    // shared block is taken from the pool-wide count before it is counted
+    // here, so a concurrent free can only return one that really was taken.
+    uint64_t state = held.load(std::memory_order_relaxed);
+    bool haveShared = false;
+    uint64_t claim;
+    while (true) {
+        size_t reservedHeld = state & RESERVED_MASK;
+        size_t sharedHeld = state >> 32;
+        if (reservedHeld + sharedHeld >= quota) {
+            if (haveShared) {
+                owner.releaseShared();
+            }
+            quotaFailures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        if (reservedHeld < reserved) {
+            claim = 1;
+        } else if (!haveShared) {
+            if (!owner.takeShared()) {
+                sharedFailures.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            haveShared = true;
+            continue;
+        } else {
+            claim = SHARED_ONE;
+        }
+        if (held.compare_exchange_weak(state, state + claim, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    // A reserved block came free while the shared one was being taken
+    if (haveShared && claim != SHARED_ONE) {
+        owner.releaseShared();
+    }
+
+    // Only fails if callers outside the tenants drained the pool
+    void* block = owner.pool.allocate();
+    if (!block) {
+        release();
+        sharedFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return block;
+}
+
+void TenantPool::Tenant::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    owner.pool.deallocate(ptr);
+    release();
+}
+
+// Give back one block the caller holds, a shared one while there are any.
+// Both halves change in one CAS, so their sum never drops below the
+// blocks still held and one of them is always nonzero here.
+void TenantPool::Tenant::release() {
+    uint64_t state = held.load(std::memory_order_relaxed);
+    uint64_t step;
+    do {
+        step = (state >> 32) != 0 ? SHARED_ONE : 1;
+    } while (!held.compare_exchange_weak(state, state - step, std::memory_order_relaxed));
+    if (step == SHARED_ONE) {
+        owner.releaseShared();
+    }
+}
+
+TenantStats TenantPool::Tenant::getStats() const {
+    uint64_t state = held.load(std::memory_order_relaxed);
+    TenantStats stats;
+    stats.used = (state & RESERVED_MASK) + (state >> 32);
+    stats.shared = state >> 32;
+    stats.quota = quota;
+    stats.reserved = reserved;
+    stats.quotaFailures = quotaFailures.load(std::memory_order_relaxed);
+    stats.sharedFailures = sharedFailures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+TenantPool::TenantPool(MemoryPool& pool, size_t capacity)
+    : pool(pool)
+    , sharedCapacity(capacity > 0 ? capacity : pool.getTotalBlocks())
+    , sharedUsed(0) {
+}
+
+TenantPool::Tenant& TenantPool::addTenant(size_t quota, size_t reserved) {
+    if (reserved > quota) {
+        throw std::invalid_argument("Reserved blocks cannot exceed the quota");
+    }
+    if (quota > RESERVED_MASK) {
+        throw std::invalid_argument("Quota must fit in 32 bits");
+    }
+    std::lock_guard<std::mutex> lock(tenantsMutex);
+    size_t capacity = sharedCapacity.load(std::memory_order_relaxed);
+    do {
+        if (capacity < reserved || capacity - reserved < sharedUsed.load(std::memory_order_relaxed)) {
+            throw std::invalid_argument("Reservation exceeds the unreserved capacity");
+        }
+    } while (!sharedCapacity.compare_exchange_weak(capacity, capacity - reserved, std::memory_order_relaxed));
+    tenants.push_back(std::unique_ptr<Tenant>(new Tenant(*this, quota, reserved)));
+    return *tenants.back();
+}
+
+bool TenantPool::takeShared() {
+    size_t current = sharedUsed.load(std::memory_order_relaxed);
+    do {
+        if (current >= sharedCapacity.load(std::memory_order_relaxed)) {
+            return false;
+        }
+    } while (!sharedUsed.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef TENANT_POOL_H
+#define TENANT_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class MemoryPool;
+
+struct TenantStats {
+    size_t used;                    // Blocks held now
+    size_t shared;                  // Of those, blocks taken from the shared part
+    size_t quota;                   // Most blocks the tenant may hold
+    size_t reserved;                // Blocks kept for the tenant alone
+    size_t quotaFailures;           // Refused at the tenant's own quota
+    size_t sharedFailures;          // Refused because the shared blocks ran out
+};
+
+// Per-tenant quotas and reserved minimums on one shared MemoryPool.
+//
+// Each tenant may hold up to its quota. Its first reserved blocks are
+// guaranteed: they are set aside from the pool's capacity, and only what
+// is left (the shared part) is open to every tenant. A noisy tenant can
+// therefore exhaust its quota or the shared part, but never another
+// tenant's reservation. Counters are atomics updated with CAS on the
+// tenant's own counter and, past the reservation, one shared counter; no
+// lock is taken beyond the pool's own. The tenant counts its reserved
+// and shared blocks in one word, so a free always returns a shared block
+// that an allocation actually took, whatever the interleaving.
+//
+//   TenantPool tenants(pool);
+//   TenantPool::Tenant& search = tenants.addTenant(4000, 500);
+//   void* p = search.allocate();            // nullptr at quota or when shared blocks run out
+//   search.deallocate(p);
+class TenantPool {
+public:
+    class Tenant {
+    public:
+        void* allocate();
+        void deallocate(void* ptr);
+        TenantStats getStats() const;
+
+    private:
+        friend class TenantPool;
+        Tenant(TenantPool& owner, size_t quota, size_t reserved);
+        void release();
+
+        TenantPool& owner;
+        const size_t quota;
+        const size_t reserved;
+        std::atomic<uint64_t> held;         // Reserved blocks in the low half, shared in the high
+        std::atomic<size_t> quotaFailures;
+        std::atomic<size_t> sharedFailures;
+    };
+
+    // capacity defaults to the pool's total blocks; lower it when the pool
+    // also serves callers outside any tenant
+    explicit TenantPool(MemoryPool& pool, size_t capacity = 0);
+
+    TenantPool(const TenantPool&) = delete;
+    TenantPool& operator=(const TenantPool&) = delete;
+
+    // Throws std::invalid_argument if reserved > quota, the quota does not
+    // fit in 32 bits, or the reservation no longer fits in the unreserved
+    // capacity. Best done before traffic
+    // starts; the tenant lives as long as the TenantPool.
+    Tenant& addTenant(size_t quota, size_t reserved = 0);
+
+    size_t getSharedCapacity() const { return sharedCapacity.load(std::memory_order_relaxed); }
+    size_t getSharedUsed() const { return sharedUsed.load(std::memory_order_relaxed); }
+
+private:
+    MemoryPool& pool;
+    std::atomic<size_t> sharedCapacity;     // Capacity minus every reservation
+    char padding[56];
+    std::atomic<size_t> sharedUsed;         // Blocks held beyond reservations
+
+    std::mutex tenantsMutex;                // Guards tenants
+    std::vector<std::unique_ptr<Tenant>> tenants;
+
+    bool takeShared();
+    void releaseShared() { sharedUsed.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+#endif // TENANT_POOL_H
@@ -1,8 +1,36 @@
 #include "MemoryPool.h"
+#include "AlignedChunkPool.h"
+#include "AsyncAllocator.h"
+#include "BasicPool.h"
+#include "BitmapPool.h"
+#include "BlockLinker.h"
+#include "DelegatedAllocator.h"
+#include "HeapProfiler.h"
+#include "MemoryPressure.h"
+#include "PageMap.h"
+#include "EpochReclaimer.h"
+#include "PoolRegistry.h"
+#include "PoolSnapshot.h"
+#include "SmallObjectAllocator.h"
+#include "SpscRing.h"
+#include "TenantPool.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <chrono>
 #include <thread>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 // Color codes for output
 #define GREEN "\033[32m"
@@ -289,6 +317,1994 @@ void testDifferentBlockSizes() {
     printTestResult("Various block sizes", true);
 }
 
+// Test 12: Quarantine
+void testQuarantine() {
+    std::cout << YELLOW << "\n=== Test 12: Quarantine ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.quarantineBlocks = 4;
+    MemoryPool pool(32, 8, options);
+    
+    // A freed block must not be handed straight back out
+    void* ptr = pool.allocate();
+    pool.deallocate(ptr);
+    void* next = pool.allocate();
+    assert(next != ptr);
+    assert(pool.getQuarantineStats().held == 1);
+    printTestResult("Freed block is not reused immediately", true);
+    
+    // Writing to a quarantined block is reported when it leaves quarantine
+    static_cast<char*>(ptr)[5] = 42;
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+        void* p = pool.allocate();
+        pool.deallocate(p);
+    }
+    QuarantineStats stats = pool.getQuarantineStats();
+    assert(stats.corruptions == 1);
+    assert(stats.held == 4);
+    printTestResult("Use-after-free detected on release", true);
+    
+    // Quarantined blocks still count as free, so the pool drains fully
+    while (void* p = pool.allocate()) {
+        ptrs.push_back(p);
+    }
+    assert(ptrs.size() == 7);
+    assert(pool.isExhausted());
+    printTestResult("Exhaustion recycles quarantined blocks", true);
+    
+    for (void* p : ptrs) {
+        pool.deallocate(p);
+    }
+    pool.deallocate(next);
+    assert(pool.getUsedBlocks() == 0);
+    printTestResult("Quarantine accounting", true);
+    
+    // Only the first 64 bytes are poisoned unless the whole block is asked for
+    for (bool poisonAll : { false, true }) {
+        PoolOptions large;
+        large.quarantineBlocks = 1;
+        large.quarantinePoisonAll = poisonAll;
+        MemoryPool bigPool(256, 4, large);
+        char* stale = static_cast<char*>(bigPool.allocate());
+        bigPool.deallocate(stale);
+        stale[200] = 42;
+        bigPool.deallocate(bigPool.allocate());
+        assert(bigPool.getQuarantineStats().corruptions == (poisonAll ? 1u : 0u));
+    }
+    printTestResult("Poison prefix, or whole block on request", true);
+    
+    // Enabling it at runtime follows the constructor's rules
+    MemoryPool plain(64, 16);
+    assert(!plain.setTunable("quarantine_blocks", 17));
+    assert(plain.setTunable("quarantine_blocks", 16));
+    assert(plain.getQuarantineStats().capacity == 16);
+    PoolOptions cached;
+    cached.cache = PoolCache::PerThread;
+    MemoryPool cachedPool(64, 16, cached);
+    assert(!cachedPool.setTunable("quarantine_blocks", 4));
+    PoolOptions lockFree;
+    lockFree.lockFree = true;
+    MemoryPool lockFreePool(64, 16, lockFree);
+    assert(!lockFreePool.setTunable("quarantine_blocks", 4));
+    assert(lockFreePool.getQuarantineStats().capacity == 0);
+    printTestResult("Runtime quarantine refused where it cannot work", true);
+}
+
+// Test 13: Leak report by allocation site
+void testLeakTracking() {
+    std::cout << YELLOW << "\n=== Test 13: Leak Tracking ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.trackLeaks = true;
+    MemoryPool pool(48, 20, options);
+    
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 3; ++i) {
+        ptrs.push_back(pool.allocateTagged("parser"));
+    }
+    ptrs.push_back(pool.allocateTagged("session"));
+    ptrs.push_back(pool.allocate());
+    pool.deallocate(ptrs[0]);
+    
+    std::vector<LeakSite> leaks = pool.collectLeaks();
+    assert(leaks.size() == 3);
+    assert(leaks[0].tagged && std::string(static_cast<const char*>(leaks[0].site)) == "parser");
+    assert(leaks[0].blocks == 2);
+    assert(leaks[0].bytes == 2 * pool.getBlockSize());
+    printTestResult("Live blocks grouped by site", true);
+    
+    size_t untagged = 0;
+    for (const LeakSite& leak : leaks) {
+        untagged += leak.tagged ? 0 : leak.blocks;
+    }
+    assert(untagged == 1);
+    printTestResult("Return address captured for untagged allocations", true);
+    
+    pool.reset();
+    assert(pool.collectLeaks().empty());
+    printTestResult("Reset clears tracked sites", true);
+    
+    // Sampling tracks only every Nth allocation
+    options.leakSampleRate = 4;
+    MemoryPool sampled(48, 20, options);
+    for (int i = 0; i < 8; ++i) {
+        sampled.allocateTagged("sampled");
+    }
+    assert(sampled.collectLeaks()[0].blocks == 2);
+    sampled.reset();
+    printTestResult("Sampled tracking", true);
+}
+
+// Test 14: Sampling heap profiler
+void testHeapProfiler() {
+    std::cout << YELLOW << "\n=== Test 14: Heap Profiler ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 16);
+    void* before = pool.allocate();     // Profiler off: never sampled
+    
+    HeapProfiler::start(1);             // Interval below block size: sample everything
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 4; ++i) {
+        ptrs.push_back(pool.allocate());
+    }
+    HeapProfiler::stop();
+    assert(HeapProfiler::getLiveSamples() == 4);
+    printTestResult("Allocations sampled while active", true);
+    
+    pool.deallocate(before);
+    pool.deallocate(ptrs[0]);
+    assert(HeapProfiler::getLiveSamples() == 3);
+    printTestResult("Freed samples retired after stop()", true);
+    
+    std::ostringstream profile;
+    HeapProfiler::writeHeapProfile(profile);
+    assert(profile.str().compare(0, 16, "heap profile: 3:") == 0);
+    assert(profile.str().find("MAPPED_LIBRARIES:") != std::string::npos);
+    std::ostringstream folded;
+    HeapProfiler::writeFoldedStacks(folded);
+    assert(!folded.str().empty());
+    printTestResult("pprof and folded-stack output", true);
+    
+    pool.reset();
+    assert(HeapProfiler::getLiveSamples() == 0);
+    HeapProfiler::start(1);
+    void* again = pool.allocate();
+    HeapProfiler::stop();
+    assert(HeapProfiler::getLiveSamples() == 1);
+    pool.deallocate(again);
+    assert(HeapProfiler::getLiveSamples() == 0);
+    printTestResult("Reset retires pool samples", true);
+    
+    // Small objects are retired through their span's sample count; an
+    // unsampled neighbour in the same span leaves the sample alone
+    HeapProfiler::start(1);
+    void* object = SmallObjectAllocator::allocate(40);
+    HeapProfiler::stop();
+    void* neighbour = SmallObjectAllocator::allocate(40);
+    assert(HeapProfiler::getLiveSamples() == 1);
+    SmallObjectAllocator::deallocate(neighbour, 40);
+    assert(HeapProfiler::getLiveSamples() == 1);
+    SmallObjectAllocator::deallocate(object, 40);
+    assert(HeapProfiler::getLiveSamples() == 0);
+    printTestResult("Small-object samples retired", true);
+}
+
+// Test 15: Occupancy snapshot
+void testSnapshot() {
+    std::cout << YELLOW << "\n=== Test 15: Occupancy Snapshot ===" << RESET << std::endl;
+    
+    MemoryPool pool(50, 200);           // Rounded up to 64-byte blocks
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 100; ++i) {
+        ptrs.push_back(pool.allocate());
+    }
+    for (int i = 0; i < 100; i += 2) {
+        pool.deallocate(ptrs[i]);
+    }
+    
+    PoolSnapshot snapshot = pool.takeSnapshot();
+    assert(snapshot.liveBlocks == 50);
+    assert(snapshot.alignmentWasteBytes() == 50 * (pool.getBlockSize() - 50));
+    size_t live = 0, blocks = 0;
+    for (size_t page = 0; page < snapshot.pageLiveBlocks.size(); ++page) {
+        live += snapshot.pageLiveBlocks[page];
+        blocks += snapshot.blocksInPage(page);
+        assert(snapshot.pageLiveBlocks[page] <= snapshot.blocksInPage(page));
+    }
+    assert(live == 50);
+    assert(blocks == 200);
+    printTestResult("Per-page live counts", true);
+    
+    std::ostringstream json;
+    snapshot.writeJson(json);
+    assert(json.str().find("\"liveBlocks\":50") != std::string::npos);
+    
+    std::stringstream binary;
+    snapshot.writeBinary(binary);
+    PoolSnapshot decoded;
+    assert(PoolSnapshot::readBinary(binary, decoded));
+    assert(decoded.liveBlocks == 50 && decoded.requestedSize == 50);
+    assert(decoded.pageLiveBlocks == snapshot.pageLiveBlocks);
+    printTestResult("JSON and binary export", true);
+    
+    // A page count that disagrees with the header or the data is refused
+    std::string bytes = binary.str();
+    std::string forged = bytes;
+    forged[4 + 4 + 7 * 8] = '\x7f';        // Low byte of the page count
+    std::stringstream forgedStream(forged);
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+    assert(!PoolSnapshot::readBinary(forgedStream, decoded));
+    assert(!PoolSnapshot::readBinary(truncated, decoded));
+    
+    // Geometry whose byte span wraps when rounded up to a page
+    PoolSnapshot huge = snapshot;
+    huge.blockSize = 1;
+    huge.totalBlocks = SIZE_MAX;
+    huge.firstBlockOffset = 0;
+    huge.pageLiveBlocks.clear();
+    std::stringstream hugeStream;
+    huge.writeBinary(hugeStream);
+    assert(!PoolSnapshot::readBinary(hugeStream, decoded));
+    printTestResult("Corrupt page counts rejected", true);
+    
+    // Free lists longer than one batch are walked with the lock dropped in
+    // between; a quiescent pool still gives the exact map
+    MemoryPool busy(64, 20000, true);
+    std::vector<void*> busyPtrs;
+    for (int i = 0; i < 20000; ++i) {
+        busyPtrs.push_back(busy.allocate());
+    }
+    for (int i = 0; i < 20000; i += 2) {
+        busy.deallocate(busyPtrs[i]);
+    }
+    PoolSnapshot batched = busy.takeSnapshot();
+    size_t batchedLive = 0;
+    for (size_t page = 0; page < batched.pageLiveBlocks.size(); ++page) {
+        assert(batched.pageLiveBlocks[page] == batched.blocksInPage(page) / 2);
+        batchedLive += batched.pageLiveBlocks[page];
+    }
+    assert(batched.liveBlocks == 10000 && batchedLive == 10000);
+    
+    // Allocations racing the walk only move blocks between states
+    std::atomic<bool> churning(true);
+    std::thread churn([&busy, &churning]() {
+        std::vector<void*> held;
+        while (churning.load()) {
+            for (int i = 0; i < 64; ++i) {
+                held.push_back(busy.allocate());
+            }
+            for (void* ptr : held) {
+                busy.deallocate(ptr);
+            }
+            held.clear();
+        }
+    });
+    for (int round = 0; round < 50; ++round) {
+        PoolSnapshot racing = busy.takeSnapshot();
+        for (size_t page = 0; page < racing.pageLiveBlocks.size(); ++page) {
+            assert(racing.pageLiveBlocks[page] <= racing.blocksInPage(page));
+        }
+    }
+    churning = false;
+    churn.join();
+    assert(busy.takeSnapshot().liveBlocks == 10000);
+    busy.reset();
+    printTestResult("Free list walked in batches", true);
+    
+    // Tracked per-page counts give the same map without walking the free list
+    PoolOptions options;
+    options.trackOccupancy = true;
+    options.quarantineBlocks = 4;
+    MemoryPool tracked(50, 200, options);
+    std::vector<void*> trackedPtrs;
+    for (int i = 0; i < 100; ++i) {
+        trackedPtrs.push_back(tracked.allocate());
+    }
+    for (int i = 0; i < 100; i += 2) {
+        tracked.deallocate(trackedPtrs[i]);
+    }
+    PoolSnapshot counted = tracked.takeSnapshot();
+    assert(counted.liveBlocks == 50 && counted.quarantinedBlocks == 4);
+    assert(counted.pageLiveBlocks == snapshot.pageLiveBlocks);
+    tracked.reset();
+    counted = tracked.takeSnapshot();
+    assert(counted.liveBlocks == 0);
+    assert(std::count(counted.pageLiveBlocks.begin(), counted.pageLiveBlocks.end(), 0) ==
+           static_cast<std::ptrdiff_t>(counted.pageLiveBlocks.size()));
+    printTestResult("Tracked occupancy copied under the lock", true);
+    
+    pool.reset();
+}
+
+// Test 16: Trim releases whole free pages
+void testTrim() {
+    std::cout << YELLOW << "\n=== Test 16: Trim ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 1024);          // 64 KB: 16 pages of 4 KB
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 1024; ++i) {
+        ptrs.push_back(pool.allocate());
+    }
+    for (int i = 0; i < 512; ++i) {     // Free the first half of the pool
+        pool.deallocate(ptrs[i]);
+    }
+    
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t released = pool.trim();
+    assert(released == (512 * 64 / page) * page);
+    assert(pool.getFreeBlocks() == 512);
+    printTestResult("Fully free pages released", true);
+    
+    // Released blocks come back on demand
+    std::vector<void*> again;
+    while (void* ptr = pool.allocate()) {
+        static_cast<char*>(ptr)[0] = 1;
+        again.push_back(ptr);
+    }
+    assert(again.size() == 512);
+    printTestResult("Released blocks reallocated", true);
+    
+    pool.reset();
+    assert(pool.getFreeBlocks() == 1024);
+}
+
+// Test 17: Pool registry and control protocol
+void testRegistry() {
+    std::cout << YELLOW << "\n=== Test 17: Pool Registry ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.name = "sessions";
+    options.threadSafe = true;
+    MemoryPool pool(64, 128, options);
+    void* ptr = pool.allocate();
+    
+    std::vector<PoolInfo> pools = PoolRegistry::list();
+    assert(pools.size() == 1 && pools[0].name == "sessions" && pools[0].usedBlocks == 1);
+    printTestResult("Named pool listed", true);
+    
+    assert(PoolRegistry::setTunable("sessions", "quarantine_blocks", 8));
+    assert(!PoolRegistry::setTunable("sessions", "no_such_key", 1));
+    pool.deallocate(ptr);
+    assert(pool.getQuarantineStats().held == 1);
+    assert(PoolRegistry::handleCommand("trim sessions").compare(0, 9, "released ") == 0);
+    assert(pool.getQuarantineStats().held == 0);
+    printTestResult("Trim and tunables by name", true);
+    
+    // Commands run on the caller's thread, so unlocked pools are left alone
+    {
+        PoolOptions unlocked;
+        unlocked.name = "scratch";
+        MemoryPool scratch(64, 16, unlocked);
+        size_t refused = 0;
+        assert(!PoolRegistry::trim("scratch", nullptr, &refused) && refused == 1);
+        assert(!PoolRegistry::setTunable("scratch", "quarantine_blocks", 8));
+        assert(scratch.getQuarantineStats().capacity == 0);
+        assert(PoolRegistry::handleCommand("trim scratch") == "error: scratch is not thread-safe\n");
+        assert(PoolRegistry::handleCommand("set * soft_watermark 4")
+               == "ok (1 pools not thread-safe, skipped)\n");
+        assert(PoolRegistry::handleCommand("trim *").find("(1 pools not thread-safe, skipped)")
+               != std::string::npos);
+        // Only its geometry is listed; its counters belong to its own thread
+        assert(PoolRegistry::handleCommand("list").find("scratch block=64 total=16 not-thread-safe\n")
+               != std::string::npos);
+    }
+    printTestResult("Pools without a lock refused", true);
+    
+    // Same protocol over the Unix socket, with an idle client connected first.
+    // A regular file in the way is left alone.
+    std::string path = "/tmp/mempool_test_" + std::to_string(getpid()) + ".sock";
+    FILE* blocker = std::fopen(path.c_str(), "w");
+    assert(blocker != nullptr);
+    std::fclose(blocker);
+    assert(!PoolRegistry::startControlSocket(path) && access(path.c_str(), F_OK) == 0);
+    unlink(path.c_str());
+    assert(PoolRegistry::startControlSocket(path));
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    int idle = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(connect(idle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    const char request[] = "list\n";
+    assert(write(client, request, sizeof(request) - 1) == sizeof(request) - 1);
+    std::string reply;
+    char buffer[256];
+    while (reply.find("end\n") == std::string::npos) {
+        ssize_t received = read(client, buffer, sizeof(buffer));
+        assert(received > 0);
+        reply.append(buffer, received);
+    }
+    close(client);
+    PoolRegistry::stopControlSocket();
+    close(idle);
+    assert(reply.compare(0, 9, "sessions ") == 0);
+    printTestResult("Control socket", true);
+    printTestResult("Idle client does not block others or shutdown", true);
+    printTestResult("Control socket never unlinks a regular file", true);
+    
+    int fds[2];
+    assert(pipe(fds) == 0);
+    PoolRegistry::dumpToFd(fds[1]);
+    close(fds[1]);
+    ssize_t dumped = read(fds[0], buffer, sizeof(buffer));
+    close(fds[0]);
+    assert(dumped > 0 && std::string(buffer, dumped).find("sessions block=64 total=128 used=0\n") == 0);
+    printTestResult("Signal-safe dump", true);
+}
+
+// Test 18: Prefaulted and locked pools stay resident
+void testResidentPool() {
+    std::cout << YELLOW << "\n=== Test 18: Prefault and mlock ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.prefault = true;
+    options.lockMemory = true;
+    MemoryPool pool(64, 1024, options);
+    
+    void* ptr = pool.allocate();
+    assert(ptr != nullptr);
+    pool.deallocate(ptr);
+    assert(pool.trim() == 0);
+    assert(pool.getFreeBlocks() == 1024);
+    printTestResult("Trim keeps resident pool pages", true);
+    
+    // A constructor that throws leaves no mapping or reservation behind
+    auto lockedKb = []() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmLck:") == 0) {
+                return std::stoul(line.substr(6));
+            }
+        }
+        return 0ul;
+    };
+    size_t lockedBefore = lockedKb();
+    size_t reservedBefore = MemoryPressure::getReservedBytes();
+    PoolOptions oversized = options;
+    oversized.quarantineBlocks = SIZE_MAX / 4;
+    bool caught = false;
+    try {
+        MemoryPool failing(64, 1024, oversized);
+    } catch (const std::exception&) {
+        caught = true;
+    }
+    assert(caught && MemoryPressure::getReservedBytes() == reservedBefore && lockedKb() == lockedBefore);
+    printTestResult("Failed construction unmaps and releases its reservation", true);
+}
+
+// Test 19: Zeroed allocation
+void testZeroedAllocation() {
+    std::cout << YELLOW << "\n=== Test 19: Zeroed Allocation ===" << RESET << std::endl;
+    
+    auto isZero = [](void* ptr, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(ptr);
+        for (size_t i = 0; i < size; ++i) {
+            if (bytes[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    // Without tracking every zeroed allocation is cleared explicitly
+    MemoryPool plain(64, 4);
+    void* ptr = plain.allocate();
+    std::memset(ptr, 0xAB, 64);
+    plain.deallocate(ptr);
+    ptr = plain.allocateZeroed();
+    assert(isZero(ptr, 64));
+    plain.deallocate(ptr);
+    printTestResult("allocateZeroed on a dirty block", true);
+    
+    PoolOptions options;
+    options.trackZeroed = true;
+    options.zeroOnReset = true;
+    MemoryPool pool(64, 32768, options);     // 2 MB: reset streams
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 100; ++i) {
+        void* p = pool.allocateZeroed();
+        assert(isZero(p, 64));
+        std::memset(p, 0xCD, 64);
+        ptrs.push_back(p);
+    }
+    for (void* p : ptrs) {
+        pool.deallocate(p);
+    }
+    for (int i = 0; i < 100; ++i) {
+        assert(isZero(pool.allocateZeroed(), 64));
+    }
+    printTestResult("Known-zero tracking", true);
+    
+    // reset() zeroes and relinks the whole pool
+    std::memset(ptrs[0], 0xEE, 64);
+    pool.reset();
+    size_t count = 0;
+    while (void* p = pool.allocate()) {
+        assert(isZero(static_cast<char*>(p) + sizeof(void*), 64 - sizeof(void*)));
+        ++count;
+    }
+    assert(count == 32768);
+    pool.reset();
+    printTestResult("Zeroing reset relinks every block", true);
+}
+
+// Test 20: Parallel free-list construction
+void testParallelInit() {
+    std::cout << YELLOW << "\n=== Test 20: Parallel Initialization ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.initThreads = 4;
+    options.prefault = true;
+    const size_t NUM_BLOCKS = 400000;   // 38 MB of 96-byte blocks: 4 slices
+    MemoryPool pool(96, NUM_BLOCKS, options);
+    
+    // Slices are stitched into one list in address order
+    auto drainInOrder = [&pool]() {
+        char* previous = nullptr;
+        size_t count = 0;
+        while (char* ptr = static_cast<char*>(pool.allocate())) {
+            if (previous && ptr != previous + pool.getBlockSize()) {
+                return false;
+            }
+            previous = ptr;
+            ++count;
+        }
+        return count == NUM_BLOCKS;
+    };
+    assert(drainInOrder());
+    printTestResult("Parallel construction", true);
+    
+    pool.reset();
+    assert(drainInOrder());
+    printTestResult("Parallel reset", true);
+    pool.reset();
+}
+
+// Test 21: Compile-time configured pool
+struct CheckedGrowingConfig : DefaultPoolConfig {
+    typedef SpinLock LockPolicy;
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef CountingStats StatsPolicy;
+    typedef BoundsChecked SafetyPolicy;
+    typedef MmapBacking BackingPolicy;
+};
+
+void testBasicPool() {
+    std::cout << YELLOW << "\n=== Test 21: BasicPool Policies ===" << RESET << std::endl;
+    
+    BasicPool<> plain(24, 4);
+    assert(plain.getBlockSize() % alignof(std::max_align_t) == 0);
+    std::vector<void*> blocks;
+    while (void* ptr = plain.allocate()) {
+        blocks.push_back(ptr);
+    }
+    assert(blocks.size() == 4 && plain.isExhausted());
+    for (void* ptr : blocks) {
+        plain.deallocate(ptr);
+    }
+    assert(plain.getFreeBlocks() == 4);
+    printTestResult("Default config is a fixed pool", true);
+    
+    BasicPool<CheckedGrowingConfig> pool(64, 8);
+    blocks.clear();
+    for (int i = 0; i < 20; ++i) {
+        void* ptr = pool.allocate();
+        assert(ptr != nullptr);
+        std::memset(ptr, i, 64);
+        blocks.push_back(ptr);
+    }
+    assert(pool.getChunkCount() == 3 && pool.getTotalBlocks() == 24);
+    assert(pool.peakUsed == 20 && pool.allocations == 20);
+    printTestResult("Chunked growth and counting stats", true);
+    
+    int local = 0;
+    bool caught = false;
+    try {
+        pool.deallocate(&local);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    caught = false;
+    try {
+        pool.deallocate(static_cast<char*>(blocks[0]) + 8);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Bounds-checked deallocate rejects foreign pointers", true);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < 10000; ++i) {
+                void* ptr = pool.allocate();
+                assert(ptr != nullptr);
+                pool.deallocate(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (void* ptr : blocks) {
+        pool.deallocate(ptr);
+    }
+    assert(pool.getUsedBlocks() == 0 && pool.deallocations == pool.allocations);
+    printTestResult("Spin-locked pool under contention", true);
+}
+
+// Test 22: Three-tier small-object allocator
+void testSmallObjectAllocator() {
+    std::cout << YELLOW << "\n=== Test 22: Small-Object Allocator ===" << RESET << std::endl;
+    
+    // Every size up to the largest class, rounded to a class and 16-byte aligned
+    std::vector<std::pair<void*, size_t>> objects;
+    for (size_t size = 1; size <= SmallObjectAllocator::MAX_SMALL_SIZE; size += (size < 512 ? 1 : 97)) {
+        void* ptr = SmallObjectAllocator::allocate(size);
+        assert(ptr != nullptr);
+        assert(reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+        size_t usable = SmallObjectAllocator::getAllocatedSize(size);
+        assert(usable >= size && usable <= size + size / 4 + 16);
+        std::memset(ptr, static_cast<int>(size & 0xFF), usable);
+        objects.push_back(std::make_pair(ptr, size));
+    }
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(objects[i].first);
+        assert(bytes[0] == (objects[i].second & 0xFF) && bytes[objects[i].second - 1] == (objects[i].second & 0xFF));
+        if (i % 2 == 0) {
+            SmallObjectAllocator::deallocate(objects[i].first, objects[i].second);
+        } else {
+            SmallObjectAllocator::deallocate(objects[i].first);
+        }
+    }
+    printTestResult("Size classes, sized and unsized free", true);
+    
+    void* large = SmallObjectAllocator::allocate(1024 * 1024);
+    assert(large != nullptr);
+    std::memset(large, 0xAB, 1024 * 1024);
+    SmallObjectAllocator::deallocate(large);
+    int local = 0;
+    bool caught = false;
+    try {
+        SmallObjectAllocator::deallocate(&local);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    
+    // Interior pages of coalesced free spans map to nothing, even once the
+    // merged spans' records are reused
+    const size_t LARGE = 512 * 1024;
+    char* first = static_cast<char*>(SmallObjectAllocator::allocate(LARGE));
+    char* second = static_cast<char*>(SmallObjectAllocator::allocate(LARGE));
+    SmallObjectAllocator::deallocate(first);
+    SmallObjectAllocator::deallocate(second);
+    std::vector<void*> reuse;
+    for (int i = 0; i < 64; ++i) {
+        reuse.push_back(SmallObjectAllocator::allocate(LARGE / 8));
+    }
+    for (void* ptr : reuse) {
+        SmallObjectAllocator::deallocate(ptr);
+    }
+    const char* strays[] = { first + LARGE / 2, second + LARGE / 2, second + LARGE - 1 };
+    for (const char* stray : strays) {
+        caught = false;
+        try {
+            SmallObjectAllocator::deallocate(const_cast<char*>(stray));
+        } catch (const std::invalid_argument&) {
+            caught = true;
+        }
+        assert(caught);
+    }
+    printTestResult("Large allocations and foreign pointers", true);
+    
+    // Objects allocated on one thread and freed on another find their spans
+    const size_t COUNT = 20000;
+    std::vector<void*> handoff(COUNT);
+    std::thread producer([&handoff]() {
+        for (size_t i = 0; i < COUNT; ++i) {
+            handoff[i] = SmallObjectAllocator::allocate(16 + i % 200);
+            std::memset(handoff[i], 1, 16 + i % 200);
+        }
+    });
+    producer.join();
+    std::thread consumer([&handoff]() {
+        for (size_t i = 0; i < COUNT; ++i) {
+            SmallObjectAllocator::deallocate(handoff[i], 16 + i % 200);
+        }
+    });
+    consumer.join();
+    printTestResult("Cross-thread free", true);
+    
+    // Once every cache is flushed all spans are empty, coalesce, and release
+    SmallObjectAllocator::flushThreadCache();
+    size_t released = SmallObjectAllocator::releaseFreeMemory();
+    SmallObjectStats stats = SmallObjectAllocator::getStats();
+    assert(stats.spanBytes == 0 && stats.freeBytes == 0);
+    assert(stats.releasedBytes == stats.mappedBytes && released > 0);
+    printTestResult("Empty spans return to the page heap", true);
+}
+
+// Test 23: Per-CPU and per-thread block caches
+void testBlockCaches() {
+    std::cout << YELLOW << "\n=== Test 23: Block Caches ===" << RESET << std::endl;
+    
+    const size_t NUM_BLOCKS = 4096;
+    PoolCache modes[] = { PoolCache::PerThread, PoolCache::PerCpu };
+    for (PoolCache mode : modes) {
+        PoolOptions options;
+        options.cache = mode;
+        options.cacheBlocks = 16;
+        MemoryPool pool(64, NUM_BLOCKS, options);
+        
+        // Each thread writes its id into its blocks and checks nobody else did
+        std::vector<std::thread> threads;
+        std::atomic<bool> corrupted(false);
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&pool, &corrupted, t]() {
+                std::vector<void*> held;
+                for (int i = 0; i < 20000; ++i) {
+                    if (held.size() < 64 && (i % 3 != 0 || held.empty())) {
+                        void* ptr = pool.allocate();
+                        assert(ptr != nullptr);
+                        std::memset(ptr, t, 64);
+                        held.push_back(ptr);
+                    } else {
+                        unsigned char* ptr = static_cast<unsigned char*>(held.back());
+                        held.pop_back();
+                        if (ptr[0] != t || ptr[63] != t) {
+                            corrupted = true;
+                        }
+                        pool.deallocate(ptr);
+                    }
+                }
+                for (void* ptr : held) {
+                    pool.deallocate(ptr);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(!corrupted);
+        
+        // Slabs never hold more than cacheBlocks; exited threads returned theirs
+        CacheStats stats = pool.getCacheStats();
+        if (mode == PoolCache::PerThread) {
+            assert(stats.mode == PoolCache::PerThread && stats.slabs == 0 && stats.cachedBlocks == 0);
+        } else {
+            assert(stats.cachedBlocks <= stats.slabs * 16);
+        }
+        assert(pool.getFreeBlocks() + stats.cachedBlocks == NUM_BLOCKS);
+        
+        // Draining still reaches every block, cached or not
+        std::vector<void*> all;
+        while (void* ptr = pool.allocate()) {
+            all.push_back(ptr);
+        }
+        assert(all.size() == NUM_BLOCKS);
+        for (void* ptr : all) {
+            pool.deallocate(ptr);
+        }
+        printTestResult(stats.mode == PoolCache::PerCpu ? "Per-CPU (rseq) cache" : "Per-thread cache", true);
+    }
+    
+    PoolOptions invalid;
+    invalid.cache = PoolCache::PerThread;
+    invalid.quarantineBlocks = 8;
+    bool caught = false;
+    try {
+        MemoryPool pool(64, 16, invalid);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Caches refuse per-block debugging options", true);
+}
+
+// Test 24: Epoch-based reclamation
+void testEpochReclaimer() {
+    std::cout << YELLOW << "\n=== Test 24: Epoch Reclamation ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 1024, true);
+    void* batch[3] = { pool.allocate(), pool.allocate(), pool.allocate() };
+    pool.deallocateBatch(batch, 3);
+    assert(pool.getUsedBlocks() == 0);
+    printTestResult("Batch deallocation", true);
+    
+    {
+        EpochReclaimer reclaimer(pool);
+        void* block = pool.allocate();
+        std::thread reader;
+        std::atomic<bool> pinned(false), done(false);
+        reader = std::thread([&]() {
+            EpochReclaimer::Guard guard(reclaimer);
+            pinned = true;
+            while (!done) {
+                std::this_thread::yield();
+            }
+        });
+        while (!pinned) {
+            std::this_thread::yield();
+        }
+        reclaimer.retire(block);
+        reclaimer.collect();
+        assert(reclaimer.getPendingBlocks() == 1 && pool.getUsedBlocks() == 1);
+        done = true;
+        reader.join();
+        assert(reclaimer.collect() == 1 && pool.getUsedBlocks() == 0);
+    }
+    printTestResult("Retired block waits for pinned readers", true);
+    
+    // Readers check a magic word that the free-list link would overwrite
+    const uint64_t MAGIC = 0x5AFE5AFE5AFE5AFEull;
+    const size_t SLOTS = 16;
+    const size_t MAX_PENDING = 128;
+    EpochReclaimer reclaimer(pool, 16, MAX_PENDING);
+    std::atomic<uint64_t*> table[SLOTS];
+    for (auto& slot : table) {
+        uint64_t* node = static_cast<uint64_t*>(pool.allocate());
+        node[0] = MAGIC;
+        slot.store(node);
+    }
+    std::atomic<bool> stop(false), corrupted(false);
+    std::atomic<size_t> maxSeenPending(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            size_t i = 0;
+            while (!stop) {
+                EpochReclaimer::Guard guard(reclaimer);
+                uint64_t* node = table[i++ % SLOTS].load();
+                for (int spin = 0; spin < 8; ++spin) {
+                    if (node[0] != MAGIC) {
+                        corrupted = true;
+                    }
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t* node = static_cast<uint64_t*>(pool.allocate());
+        assert(node != nullptr);
+        node[0] = MAGIC;
+        uint64_t* old = table[i % SLOTS].exchange(node);
+        reclaimer.retire(old);
+        size_t pending = reclaimer.getPendingBlocks();
+        if (pending > maxSeenPending) {
+            maxSeenPending = pending;
+        }
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    assert(!corrupted);
+    assert(maxSeenPending <= MAX_PENDING);
+    printTestResult("Concurrent readers never see reclaimed blocks", true);
+    
+    for (auto& slot : table) {
+        reclaimer.retire(slot.load());
+    }
+    reclaimer.collect();
+    assert(reclaimer.getPendingBlocks() == 0 && pool.getUsedBlocks() == 0);
+    printTestResult("Garbage bounded and fully reclaimed", true);
+}
+
+// Test 25: Lock-free free list with elimination
+void testLockFreePool() {
+    std::cout << YELLOW << "\n=== Test 25: Lock-Free Pool ===" << RESET << std::endl;
+    
+    const size_t NUM_BLOCKS = 1024;
+    size_t slotCounts[] = { 0, 4 };
+    for (size_t slots : slotCounts) {
+        PoolOptions options;
+        options.lockFree = true;
+        options.eliminationSlots = slots;
+        MemoryPool pool(64, NUM_BLOCKS, options);
+        
+        // Balanced churn; a block handed to two threads at once shows up as
+        // a foreign id
+        std::vector<std::thread> threads;
+        std::atomic<bool> corrupted(false);
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&pool, &corrupted, t]() {
+                std::vector<void*> held;
+                for (int i = 0; i < 20000; ++i) {
+                    if (held.size() < 32 && (i % 2 == 0 || held.empty())) {
+                        void* ptr = pool.allocate();
+                        if (!ptr) {
+                            continue;
+                        }
+                        std::memset(ptr, t, 64);
+                        held.push_back(ptr);
+                    } else {
+                        unsigned char* ptr = static_cast<unsigned char*>(held.back());
+                        held.pop_back();
+                        if (ptr[8] != t || ptr[63] != t) {
+                            corrupted = true;
+                        }
+                        pool.deallocate(ptr);
+                    }
+                }
+                for (void* ptr : held) {
+                    pool.deallocate(ptr);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(!corrupted);
+        assert(pool.getFreeBlocks() == NUM_BLOCKS);
+        if (slots == 0) {
+            assert(pool.getEliminatedPairs() == 0);
+        }
+        
+        // Every block is still reachable exactly once
+        std::vector<void*> all;
+        while (void* ptr = pool.allocate()) {
+            all.push_back(ptr);
+        }
+        assert(all.size() == NUM_BLOCKS && pool.isExhausted());
+        std::sort(all.begin(), all.end());
+        assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+        for (void* ptr : all) {
+            pool.deallocate(ptr);
+        }
+        pool.reset();
+        assert(pool.getFreeBlocks() == NUM_BLOCKS && pool.trim() == 0);
+        printTestResult(slots ? "Lock-free pool with elimination" : "Lock-free pool", true);
+    }
+    
+    PoolOptions invalid;
+    invalid.lockFree = true;
+    invalid.trackLeaks = true;
+    bool caught = false;
+    try {
+        MemoryPool pool(64, 16, invalid);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Lock-free mode refuses per-block debugging options", true);
+    
+    // The head keeps at least 32 tag bits, so offsets stop at 64 GB
+    PoolOptions huge;
+    huge.lockFree = true;
+    caught = false;
+    try {
+        MemoryPool pool(64, size_t(1) << 30, huge);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Lock-free pools above 64 GB refused", true);
+}
+
+// Test 26: Flat-combining mode
+void testFlatCombining() {
+    std::cout << YELLOW << "\n=== Test 26: Flat Combining ===" << RESET << std::endl;
+    
+    // Quarantine included: the combiner runs the ordinary locked paths
+    const size_t NUM_BLOCKS = 1024;
+    PoolOptions options;
+    options.flatCombining = true;
+    options.quarantineBlocks = 16;
+    MemoryPool pool(64, NUM_BLOCKS, options);
+    
+    std::vector<std::thread> threads;
+    std::atomic<bool> corrupted(false);
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&pool, &corrupted, t]() {
+            std::vector<void*> held;
+            for (int i = 0; i < 10000; ++i) {
+                if (held.size() < 32 && (i % 2 == 0 || held.empty())) {
+                    void* ptr = pool.allocate();
+                    assert(ptr != nullptr);
+                    std::memset(ptr, t, 64);
+                    held.push_back(ptr);
+                } else {
+                    unsigned char* ptr = static_cast<unsigned char*>(held.back());
+                    held.pop_back();
+                    if (ptr[0] != t || ptr[63] != t) {
+                        corrupted = true;
+                    }
+                    pool.deallocate(ptr);
+                }
+            }
+            for (void* ptr : held) {
+                pool.deallocate(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(!corrupted);
+    assert(pool.getFreeBlocks() == NUM_BLOCKS);
+    assert(pool.getQuarantineStats().corruptions == 0);
+    
+    std::vector<void*> all;
+    while (void* ptr = pool.allocate()) {
+        all.push_back(ptr);
+    }
+    assert(all.size() == NUM_BLOCKS);
+    for (void* ptr : all) {
+        pool.deallocate(ptr);
+    }
+    printTestResult("Combined requests served exactly once", true);
+    
+    PoolOptions invalid;
+    invalid.flatCombining = true;
+    invalid.lockFree = true;
+    bool caught = false;
+    try {
+        MemoryPool bad(64, 16, invalid);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Flat combining refuses lockFree", true);
+}
+
+// Test 27: Delegated allocator thread
+void testDelegatedAllocator() {
+    std::cout << YELLOW << "\n=== Test 27: Delegated Allocator ===" << RESET << std::endl;
+    
+    // Only the allocator thread touches the pool, so it needs no lock
+    const size_t NUM_BLOCKS = 1024;
+    MemoryPool pool(64, NUM_BLOCKS, false);
+    {
+        DelegatedAllocator delegated(pool, 32);
+        std::vector<std::thread> threads;
+        std::atomic<bool> corrupted(false);
+        for (int t = 0; t < 4; ++t) {
+            DelegatedAllocator::Client& client = delegated.registerClient();
+            threads.emplace_back([&client, &corrupted, t]() {
+                std::vector<void*> held;
+                for (int i = 0; i < 20000; ++i) {
+                    if (held.size() < 48 && (i % 2 == 0 || held.empty())) {
+                        void* ptr = client.allocate();
+                        assert(ptr != nullptr);
+                        std::memset(ptr, t, 64);
+                        held.push_back(ptr);
+                    } else {
+                        unsigned char* ptr = static_cast<unsigned char*>(held.back());
+                        held.pop_back();
+                        if (ptr[0] != t || ptr[63] != t) {
+                            corrupted = true;
+                        }
+                        client.deallocate(ptr);
+                    }
+                }
+                for (void* ptr : held) {
+                    client.deallocate(ptr);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(!corrupted);
+        assert(delegated.getClientCount() == 4);
+    }
+    assert(pool.getFreeBlocks() == NUM_BLOCKS);
+    printTestResult("Clients served through rings; all blocks returned", true);
+    
+    // A client gets every block of a small pool, then nullptr
+    MemoryPool small(64, 40, false);
+    {
+        DelegatedAllocator delegated(small, 16);
+        DelegatedAllocator::Client& client = delegated.registerClient();
+        std::vector<void*> all;
+        while (void* ptr = client.allocate()) {
+            all.push_back(ptr);
+        }
+        assert(all.size() == 40);
+        for (void* ptr : all) {
+            client.deallocate(ptr);
+        }
+    }
+    assert(small.getFreeBlocks() == 40);
+    printTestResult("Exhaustion reported to clients", true);
+    
+    // Each client fails only on its own confirmed empty pool, and recovers
+    // once blocks come back
+    {
+        DelegatedAllocator delegated(small, 16);
+        DelegatedAllocator::Client& first = delegated.registerClient();
+        DelegatedAllocator::Client& second = delegated.registerClient();
+        std::vector<void*> firstHeld;
+        std::vector<void*> secondHeld;
+        while (void* ptr = first.allocate()) {
+            firstHeld.push_back(ptr);
+        }
+        while (void* ptr = second.allocate()) {
+            secondHeld.push_back(ptr);
+        }
+        assert(firstHeld.size() + secondHeld.size() == 40);
+        for (void* ptr : firstHeld) {
+            first.deallocate(ptr);
+        }
+        // The first client's ring keeps 16 of them; the rest reach the pool
+        size_t refilled = 0;
+        while (void* ptr = second.allocate()) {
+            secondHeld.push_back(ptr);
+            ++refilled;
+        }
+        assert(refilled == firstHeld.size() - 16);
+        for (void* ptr : secondHeld) {
+            second.deallocate(ptr);
+        }
+    }
+    assert(small.getFreeBlocks() == 40);
+    printTestResult("Exhaustion confirmed per client", true);
+}
+
+// Test 28: Blocking allocation with timeout
+void testAllocateWait() {
+    std::cout << YELLOW << "\n=== Test 28: Blocking Allocation ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 4, true);
+    std::vector<void*> all;
+    for (int i = 0; i < 4; ++i) {
+        all.push_back(pool.allocate());
+    }
+    
+    // Exhausted and nobody frees: times out
+    auto start = std::chrono::steady_clock::now();
+    assert(pool.allocateWait(std::chrono::milliseconds(20)) == nullptr);
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    printTestResult("Times out on an exhausted pool", true);
+    
+    // A free from another thread wakes the sleeper with that block
+    void* freed = all.back();
+    all.pop_back();
+    std::thread releaser([&pool, freed]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        pool.deallocate(freed);
+    });
+    start = std::chrono::steady_clock::now();
+    void* ptr = pool.allocateWait(std::chrono::seconds(10));
+    releaser.join();
+    assert(ptr == freed);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    all.push_back(ptr);
+    for (void* block : all) {
+        pool.deallocate(block);
+    }
+    printTestResult("Woken by deallocate() in another thread", true);
+    
+    // More threads than blocks: everyone gets through by waiting, on both
+    // the locked and the lock-free free list
+    PoolOptions lockFree;
+    lockFree.lockFree = true;
+    MemoryPool shared(64, 2, lockFree);
+    MemoryPool* pools[] = { &pool, &shared };
+    for (MemoryPool* target : pools) {
+        std::vector<std::thread> threads;
+        std::atomic<int> served(0);
+        for (int t = 0; t < 6; ++t) {
+            threads.emplace_back([target, &served]() {
+                for (int i = 0; i < 500; ++i) {
+                    void* block = target->allocateWait(std::chrono::seconds(10));
+                    assert(block != nullptr);
+                    std::this_thread::yield();
+                    target->deallocate(block);
+                    served.fetch_add(1);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        assert(served.load() == 3000);
+        assert(target->getFreeBlocks() == target->getTotalBlocks());
+    }
+    printTestResult("Oversubscribed pools hand blocks to waiters", true);
+}
+
+// Test 29: Memory-pressure callbacks and limits
+struct BudgetedConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef BudgetedBacking<MallocBacking> BackingPolicy;
+};
+
+void testMemoryPressure() {
+    std::cout << YELLOW << "\n=== Test 29: Memory Pressure ===" << RESET << std::endl;
+    
+    // The callback sheds held blocks back into the pool that raised it
+    std::vector<void*> cache;
+    int fired = 0;
+    PoolOptions options;
+    options.threadSafe = true;
+    options.softWatermark = 80;
+    options.onPressure = [&](MemoryPool& pool) {
+        ++fired;
+        for (int i = 0; i < 20; ++i) {
+            pool.deallocate(cache.back());
+            cache.pop_back();
+        }
+    };
+    MemoryPool pool(64, 100, options);
+    for (int i = 0; i < 79; ++i) {
+        cache.push_back(pool.allocate());
+    }
+    assert(fired == 0);
+    cache.push_back(pool.allocate());
+    assert(fired == 1 && pool.getUsedBlocks() == 60);
+    for (int i = 0; i < 20; ++i) {
+        cache.push_back(pool.allocate());
+    }
+    assert(fired == 2 && pool.getUsedBlocks() == 60);
+    assert(pool.setTunable("soft_watermark", 0));
+    while (void* ptr = pool.allocate()) {
+        cache.push_back(ptr);
+    }
+    assert(fired == 2);
+    for (void* ptr : cache) {
+        pool.deallocate(ptr);
+    }
+    printTestResult("Pool watermark fires on each crossing and may free", true);
+    
+    // Process-wide watermark over every pool's reservation
+    size_t reservedBefore = MemoryPressure::getReservedBytes();
+    size_t seen = 0;
+    int id = MemoryPressure::addCallback(reservedBefore + 1024 * 1024, [&](size_t reserved) {
+        seen = reserved;
+    });
+    {
+        MemoryPool large(4096, 512);
+        assert(seen >= reservedBefore + 2 * 1024 * 1024);
+    }
+    assert(MemoryPressure::getReservedBytes() == reservedBefore);
+    MemoryPressure::removeCallback(id);
+    printTestResult("Global watermark over all pools", true);
+    
+    // Growable pools stop at the hard limit; allocate() reports exhaustion
+    MemoryPressure::setHardLimit(MemoryPressure::getGrowableBytes() + 2 * 64 * 64);
+    {
+        BasicPool<BudgetedConfig> growing(64, 64);
+        std::vector<void*> blocks;
+        while (void* ptr = growing.allocate()) {
+            blocks.push_back(ptr);
+        }
+        assert(blocks.size() == 128 && growing.getChunkCount() == 2);
+        for (void* ptr : blocks) {
+            growing.deallocate(ptr);
+        }
+    }
+    MemoryPressure::setHardLimit(0);
+    printTestResult("Hard limit caps growable pools", true);
+    
+    CgroupMemory memory;
+    if (MemoryPressure::readCgroupMemory(memory)) {
+        assert(MemoryPressure::applyCgroupLimits() && MemoryPressure::getHardLimit() > 0);
+        MemoryPressure::setHardLimit(0);
+        printTestResult("Hard limit derived from cgroup v2", true);
+    } else {
+        std::cout << "  (no cgroup v2 memory limit here, default left unlimited)\n";
+    }
+}
+
+// Test 30: Per-tenant quotas
+void testTenantQuotas() {
+    std::cout << YELLOW << "\n=== Test 30: Tenant Quotas ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 100, true);
+    TenantPool tenants(pool);
+    TenantPool::Tenant& noisy = tenants.addTenant(90, 10);
+    TenantPool::Tenant& quiet = tenants.addTenant(40, 30);
+    assert(tenants.getSharedCapacity() == 60);
+    
+    // The noisy tenant gets its reservation plus every shared block, and
+    // no further, even under its quota
+    std::vector<void*> noisyBlocks;
+    while (void* ptr = noisy.allocate()) {
+        noisyBlocks.push_back(ptr);
+    }
+    assert(noisyBlocks.size() == 70);
+    TenantStats stats = noisy.getStats();
+    assert(stats.used == 70 && stats.shared == 60 && stats.sharedFailures == 1 && stats.quotaFailures == 0);
+    
+    // The quiet tenant's reservation is intact
+    std::vector<void*> quietBlocks;
+    while (void* ptr = quiet.allocate()) {
+        quietBlocks.push_back(ptr);
+    }
+    assert(quietBlocks.size() == 30 && pool.isExhausted());
+    printTestResult("Reserved minimums survive a noisy tenant", true);
+    
+    // Shared blocks freed by one tenant go to the other, up to its quota
+    for (int i = 0; i < 20; ++i) {
+        noisy.deallocate(noisyBlocks.back());
+        noisyBlocks.pop_back();
+    }
+    while (void* ptr = quiet.allocate()) {
+        quietBlocks.push_back(ptr);
+    }
+    stats = quiet.getStats();
+    assert(quietBlocks.size() == 40 && stats.quotaFailures == 1 && tenants.getSharedUsed() == 50);
+    for (void* ptr : quietBlocks) {
+        quiet.deallocate(ptr);
+    }
+    for (void* ptr : noisyBlocks) {
+        noisy.deallocate(ptr);
+    }
+    assert(tenants.getSharedUsed() == 0 && pool.getFreeBlocks() == 100);
+    printTestResult("Quota and shared failures counted per tenant", true);
+    
+    // Concurrent tenants keep the counters exact
+    std::vector<TenantPool::Tenant*> list = { &noisy, &quiet };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&list, t]() {
+            TenantPool::Tenant& tenant = *list[t % 2];
+            std::vector<void*> held;
+            for (int i = 0; i < 20000; ++i) {
+                if (held.size() < 30 && i % 3 != 0) {
+                    if (void* ptr = tenant.allocate()) {
+                        held.push_back(ptr);
+                    }
+                } else if (!held.empty()) {
+                    tenant.deallocate(held.back());
+                    held.pop_back();
+                }
+            }
+            for (void* ptr : held) {
+                tenant.deallocate(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(noisy.getStats().used == 0 && quiet.getStats().used == 0);
+    assert(tenants.getSharedUsed() == 0 && pool.getFreeBlocks() == 100);
+    
+    // Threads of one tenant race across its reservation boundary; frees
+    // must return exactly the shared blocks that were taken
+    MemoryPool busyPool(64, 2000, true);
+    TenantPool busyTenants(busyPool);
+    TenantPool::Tenant& busy = busyTenants.addTenant(1000, 4);
+    std::atomic<bool> running(true);
+    std::atomic<bool> overShared(false);
+    threads.clear();
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&busy]() {
+            std::vector<void*> held;
+            for (int i = 0; i < 50000; ++i) {
+                if (held.size() < 3 && i % 5 != 0) {
+                    if (void* ptr = busy.allocate()) {
+                        held.push_back(ptr);
+                    }
+                } else if (!held.empty()) {
+                    busy.deallocate(held.back());
+                    held.pop_back();
+                }
+            }
+            for (void* ptr : held) {
+                busy.deallocate(ptr);
+            }
+        });
+    }
+    std::thread watcher([&]() {
+        while (running.load()) {
+            if (busyTenants.getSharedUsed() > busyTenants.getSharedCapacity()) {
+                overShared = true;
+            }
+            std::this_thread::yield();
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    running = false;
+    watcher.join();
+    stats = busy.getStats();
+    assert(!overShared.load() && stats.used == 0 && stats.shared == 0);
+    assert(busyTenants.getSharedUsed() == 0 && busyPool.getFreeBlocks() == 2000);
+    
+    bool caught = false;
+    try {
+        tenants.addTenant(50, 61);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Concurrent accounting stays exact", true);
+}
+
+// Test 31: High-priority block reserve
+void testPriorityReserve() {
+    std::cout << YELLOW << "\n=== Test 31: Priority Reserve ===" << RESET << std::endl;
+    
+    PoolOptions options;
+    options.threadSafe = true;
+    options.highPriorityReserve = 10;
+    MemoryPool pool(64, 100, options);
+    
+    // Low priority stops at the reserve; high priority takes the rest
+    std::vector<void*> data;
+    while (void* ptr = pool.allocate()) {
+        data.push_back(ptr);
+    }
+    assert(data.size() == 90 && pool.getFreeBlocks() == 10);
+    assert(pool.allocate(Priority::Low) == nullptr && pool.allocateZeroed() == nullptr);
+    std::vector<void*> control;
+    while (void* ptr = pool.allocate(Priority::High)) {
+        control.push_back(ptr);
+    }
+    assert(control.size() == 10 && pool.isExhausted());
+    printTestResult("Low priority refused at the reserve boundary", true);
+    
+    // A freed block refills the reserve before low priority sees it
+    pool.deallocate(control.back());
+    control.pop_back();
+    assert(pool.allocate() == nullptr);
+    pool.deallocate(data.back());
+    data.pop_back();
+    pool.deallocate(data.back());
+    data.pop_back();
+    assert(pool.getFreeBlocks() == 3 && pool.allocate() == nullptr);
+    for (void* ptr : control) {
+        pool.deallocate(ptr);
+    }
+    for (void* ptr : data) {
+        pool.deallocate(ptr);
+    }
+    assert(pool.getFreeBlocks() == 100);
+    
+    // The reserve is tunable; it must leave room for everyone else
+    assert(pool.setTunable("high_priority_reserve", 99) && !pool.setTunable("high_priority_reserve", 100));
+    void* ptr = pool.allocate();
+    assert(ptr != nullptr && pool.allocate() == nullptr);
+    pool.deallocate(ptr);
+    assert(pool.setTunable("high_priority_reserve", 10));
+    printTestResult("Reserve refills from frees and is tunable", true);
+    
+    // Under contention from low-priority threads, high priority never fails
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; ++t) {
+        threads.emplace_back([&pool, &stop]() {
+            std::vector<void*> held;
+            while (!stop.load()) {
+                while (void* block = pool.allocate()) {
+                    held.push_back(block);
+                }
+                for (void* block : held) {
+                    pool.deallocate(block);
+                }
+                held.clear();
+            }
+        });
+    }
+    bool allServed = true;
+    for (int i = 0; i < 20000; ++i) {
+        void* block = pool.allocate(Priority::High);
+        allServed = allServed && block != nullptr;
+        pool.deallocate(block);
+    }
+    stop.store(true);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(allServed && pool.getFreeBlocks() == 100);
+    
+    // Same guarantee through the cache and flat-combining paths
+    options.cache = PoolCache::PerThread;
+    MemoryPool cached(64, 100, options);
+    options.cache = PoolCache::None;
+    options.flatCombining = true;
+    MemoryPool combined(64, 100, options);
+    for (MemoryPool* target : { &cached, &combined }) {
+        std::vector<void*> held;
+        while (void* block = target->allocate()) {
+            held.push_back(block);
+        }
+        assert(held.size() == 90);
+        for (int i = 0; i < 10; ++i) {
+            void* block = target->allocate(Priority::High);
+            assert(block != nullptr);
+            held.push_back(block);
+        }
+        assert(target->allocate(Priority::High) == nullptr);
+        for (void* block : held) {
+            target->deallocate(block);
+        }
+    }
+    
+    bool caught = false;
+    try {
+        PoolOptions lockFree;
+        lockFree.lockFree = true;
+        lockFree.highPriorityReserve = 1;
+        MemoryPool invalid(64, 100, lockFree);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("High priority served under low-priority churn", true);
+}
+
+// Test 32: Async allocation over an eventfd
+void testAsyncAllocator() {
+    std::cout << YELLOW << "\n=== Test 32: Async Allocation ===" << RESET << std::endl;
+    
+    MemoryPool pool(64, 4, true);
+    AsyncAllocator async(pool);
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, async.getEventFd(), &event);
+    
+    // Served at once while the pool has blocks
+    std::vector<void*> held;
+    for (int i = 0; i < 4; ++i) {
+        void* ptr = async.allocate([](void*) { assert(false); });
+        assert(ptr != nullptr);
+        held.push_back(ptr);
+    }
+    
+    // Exhausted: queued, and the eventfd stays quiet until a free
+    std::vector<void*> served;
+    for (int i = 0; i < 3; ++i) {
+        void* ptr = async.allocate([&served, i](void* block) {
+            assert(static_cast<int>(served.size()) == i);
+            served.push_back(block);
+        });
+        assert(ptr == nullptr);
+    }
+    assert(async.getPendingCount() == 3);
+    assert(epoll_wait(epfd, &event, 1, 0) == 0);
+    
+    void* freed = held.back();
+    held.pop_back();
+    pool.deallocate(freed);
+    assert(epoll_wait(epfd, &event, 1, 1000) == 1);
+    assert(pool.isExhausted() && async.getPendingCount() == 2);
+    assert(async.dispatch() == 1 && served.size() == 1 && served[0] == freed);
+    assert(epoll_wait(epfd, &event, 1, 0) == 0);
+    printTestResult("Freed block reserved for the queued request", true);
+    
+    // reset() frees everything, including blocks awaiting dispatch
+    pool.deallocate(held.back());
+    held.pop_back();
+    assert(async.getPendingCount() == 1);
+    pool.reset();
+    held.clear();
+    assert(async.getPendingCount() == 0 && pool.getFreeBlocks() == 2);
+    assert(async.dispatch() == 2 && served.size() == 3);
+    pool.deallocate(served[1]);
+    pool.deallocate(served[2]);
+    assert(pool.getFreeBlocks() == 4);
+    printTestResult("FIFO completion and reset() requeue", true);
+    
+    // An epoll loop keeps 64 requests in flight against four blocks
+    // that worker threads hold briefly and free
+    const int REQUESTS = 2000;
+    std::atomic<int> completed(0);
+    int issued = 0;
+    SpscRing<void*> toWorker(4096);
+    std::atomic<bool> done(false);
+    std::thread worker([&]() {
+        void* block;
+        while (!done.load()) {
+            if (toWorker.pop(block)) {
+                pool.deallocate(block);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::function<void(void*)> onBlock = [&](void* block) {
+        completed.fetch_add(1);
+        while (!toWorker.push(block)) {
+            std::this_thread::yield();
+        }
+    };
+    while (completed.load() < REQUESTS) {
+        while (issued < REQUESTS && issued - completed.load() < 64) {
+            ++issued;
+            if (void* block = async.allocate(onBlock)) {
+                onBlock(block);
+            }
+        }
+        if (epoll_wait(epfd, &event, 1, 1000) == 1) {
+            async.dispatch();
+        }
+    }
+    done.store(true);
+    worker.join();
+    void* block;
+    while (toWorker.pop(block)) {
+        pool.deallocate(block);
+    }
+    assert(completed.load() == REQUESTS && pool.getFreeBlocks() == 4);
+    close(epfd);
+    
+    // Undispatched blocks go back when the allocator is destroyed
+    {
+        MemoryPool small(64, 1);
+        void* only = small.allocate();
+        {
+            AsyncAllocator pending(small);
+            assert(pending.allocate([](void*) {}) == nullptr);
+            small.deallocate(only);
+            assert(small.isExhausted());
+            bool caught = false;
+            try {
+                AsyncAllocator second(small);
+            } catch (const std::invalid_argument&) {
+                caught = true;
+            }
+            assert(caught);
+        }
+        assert(small.getFreeBlocks() == 1);
+    }
+    printTestResult("Epoll loop completes every request", true);
+}
+
+// Test 33: Growth inside one reserved address range
+struct ReservedConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef BoundsChecked SafetyPolicy;
+    typedef ReservedBacking<1 << 20> BackingPolicy;
+};
+
+struct BudgetedReservedConfig : DefaultPoolConfig {
+    typedef ChunkedGrowth GrowthPolicy;
+    typedef BudgetedBacking<ReservedBacking<1 << 20> > BackingPolicy;
+};
+
+void testReservedGrowth() {
+    std::cout << YELLOW << "\n=== Test 33: Reserved-Range Growth ===" << RESET << std::endl;
+    
+    // 64 KB chunks in a 1 MB reservation: 16 chunks, then growth fails
+    BasicPool<ReservedConfig> pool(64, 1024);
+    std::vector<void*> blocks;
+    while (void* ptr = pool.allocate()) {
+        std::memset(ptr, 0xAB, 64);
+        blocks.push_back(ptr);
+    }
+    assert(blocks.size() == 16384 && pool.getTotalBlocks() == 16384);
+    assert(pool.getChunkCount() == 1);
+    
+    // Every block lies in one range, with no gaps between chunks
+    char* lowest = static_cast<char*>(*std::min_element(blocks.begin(), blocks.end()));
+    char* highest = static_cast<char*>(*std::max_element(blocks.begin(), blocks.end()));
+    assert(highest - lowest == 64 * (16384 - 1));
+    printTestResult("Chunks grow contiguously up to the reservation", true);
+    
+    char local[64];
+    assert(pool.owns(lowest) && pool.owns(highest + 63));
+    assert(!pool.owns(highest + 64) && !pool.owns(local));
+    bool caught = false;
+    try {
+        pool.deallocate(local);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    for (void* ptr : blocks) {
+        pool.deallocate(ptr);
+    }
+    assert(pool.getFreeBlocks() == 16384);
+    printTestResult("owns() and bounds checks use the single range", true);
+    
+    // Only committed pages are resident; the rest of the range stays free
+    BasicPool<ReservedConfig> small(64, 64);
+    void* first = small.allocate();
+    long page = sysconf(_SC_PAGESIZE);
+    char* start = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(first) & ~uintptr_t(page - 1));
+    unsigned char residency[2] = { 0, 0 };
+    assert(mincore(start, 2 * page, residency) == 0);
+    assert((residency[0] & 1) && !(residency[1] & 1));
+    small.deallocate(first);
+    
+    // Each committed chunk counts against the growable budget
+    size_t before = MemoryPressure::getGrowableBytes();
+    {
+        BasicPool<BudgetedReservedConfig> budgeted(64, 1024);
+        void* ptr = nullptr;
+        for (int i = 0; i < 1025; ++i) {
+            ptr = budgeted.allocate();
+        }
+        assert(ptr != nullptr && MemoryPressure::getGrowableBytes() == before + 2 * 64 * 1024);
+        budgeted.deallocate(ptr);
+    }
+    assert(MemoryPressure::getGrowableBytes() == before);
+    printTestResult("RSS and budget follow committed chunks", true);
+}
+
+// Test 34: Owner lookup through aligned chunk headers
+void testAlignedChunkPool() {
+    std::cout << YELLOW << "\n=== Test 34: Aligned Chunk Pools ===" << RESET << std::endl;
+    
+    AlignedChunkPool pools({ 1000, 24, 256, 64 }, true);
+    AlignedChunkPool other({ 64 }, true);
+    void* medium = pools.allocate(200);
+    void* small = pools.allocate(1);
+    void* mine = other.allocate(64);
+    assert(medium && small && mine);
+    assert(pools.getBlockSize(medium) == 256 && pools.getBlockSize(small) == 32);
+    assert(pools.allocate(1025) == nullptr);
+    
+    // The owner is the chunk header at the masked address
+    uintptr_t chunkMask = ~uintptr_t(AlignedChunkPool::CHUNK_BYTES - 1);
+    assert((reinterpret_cast<uintptr_t>(medium) & chunkMask) != (reinterpret_cast<uintptr_t>(small) & chunkMask));
+    assert(AlignedChunkPool::ownerOf(medium) == &pools && AlignedChunkPool::ownerOf(mine) == &other);
+    assert(pools.owns(medium) && !pools.owns(mine) && other.owns(mine));
+    
+    // Foreign pointers are refused without touching their memory
+    char local[64];
+    std::unique_ptr<char[]> heap(new char[64]);
+    MemoryPool fixed(64, 16);
+    void* fixedBlock = fixed.allocate();
+    assert(!pools.owns(local) && !pools.owns(heap.get()) && !pools.owns(fixedBlock));
+    assert(AlignedChunkPool::ownerOf(local) == nullptr && AlignedChunkPool::ownerOf(fixedBlock) == nullptr);
+    assert(fixed.owns(fixedBlock) && !fixed.owns(medium));
+    fixed.deallocate(fixedBlock);
+    printTestResult("ownerOf() and owns() by pointer mask", true);
+    
+    // Unsized frees across classes and pools go to the right list
+    AlignedChunkPool::ownerOf(medium)->deallocate(medium);
+    AlignedChunkPool::ownerOf(small)->deallocate(small);
+    AlignedChunkPool::ownerOf(mine)->deallocate(mine);
+    assert(pools.allocate(256) == medium && pools.allocate(17) == small);
+    pools.deallocate(medium);
+    pools.deallocate(small);
+    
+    // A full chunk adds another; only touched pages become resident
+    std::vector<void*> blocks;
+    for (int i = 0; i < 40000; ++i) {
+        blocks.push_back(other.allocate(64));
+    }
+    AlignedChunkStats stats = other.getStats();
+    assert(stats.chunks == 2 && stats.usedBlocks == 40000);
+    char* second = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(blocks.back()) & chunkMask);
+    unsigned char residency = 0;
+    assert(mincore(second + AlignedChunkPool::CHUNK_BYTES / 2, 1, &residency) == 0 && !(residency & 1));
+    for (void* ptr : blocks) {
+        other.deallocate(ptr);
+    }
+    assert(other.getStats().usedBlocks == 0);
+    printTestResult("Unsized deallocate across classes and chunks", true);
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&pools, &other, t]() {
+            const size_t sizes[] = { 16, 64, 200, 1000 };
+            std::vector<void*> held;
+            for (int i = 0; i < 20000; ++i) {
+                AlignedChunkPool& target = (i + t) % 3 ? pools : other;
+                if (void* ptr = target.allocate(sizes[(i * 7 + t) % 4])) {
+                    held.push_back(ptr);
+                }
+                if (held.size() > 32) {
+                    void* ptr = held[(i * 13) % held.size()];
+                    held.erase(held.begin() + (i * 13) % held.size());
+                    AlignedChunkPool::ownerOf(ptr)->deallocate(ptr);
+                }
+            }
+            for (void* ptr : held) {
+                AlignedChunkPool::ownerOf(ptr)->deallocate(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(pools.getStats().usedBlocks == 0 && other.getStats().usedBlocks == 0);
+    printTestResult("Concurrent frees through ownerOf()", true);
+}
+
+// Test 35: Radix page map
+void testPageMap() {
+    std::cout << YELLOW << "\n=== Test 35: Radix Page Map ===" << RESET << std::endl;
+    
+    typedef PageMap<int, 12> Map;              // 4 KB pages, 48-bit addresses
+    std::unique_ptr<Map> map(new Map());
+    int values[4] = { 0, 1, 2, 3 };
+    uintptr_t low = uintptr_t(0x7f1234567000) >> 12;
+    uintptr_t high = (uintptr_t(1) << 36) - 1;  // Last page of the address space
+    
+    assert(map->get(low) == nullptr && map->getNodeBytes() == 0);
+    assert(map->ensure(low, 16) && map->ensure(high, 1));
+    size_t twoRanges = map->getNodeBytes();
+    map->set(low, &values[0]);
+    map->set(low + 15, &values[1]);
+    map->set(high, &values[2]);
+    assert(map->get(low) == &values[0] && map->get(low + 15) == &values[1]);
+    assert(map->get(high) == &values[2] && map->get(low + 1) == nullptr);
+    assert(map->get(high + 1) == nullptr && !map->ensure(high, 2));
+    printTestResult("Set and get across the 48-bit space", true);
+    
+    // Nodes are added only for ranges that need them
+    assert(map->ensure(low + 1, 8) && map->getNodeBytes() == twoRanges);
+    uintptr_t boundary = (low | (Map::getLeafPages() - 1)) + 1;
+    assert(map->ensure(boundary - 1, 2) && map->getNodeBytes() > twoRanges);
+    assert(map->get(boundary) == nullptr);
+    printTestResult("Interior nodes and leaves allocated lazily", true);
+    
+    // Readers never take a lock and see either null or a published value
+    uintptr_t base = uintptr_t(0x100000000) >> 12;
+    const size_t PAGES = 1 << 16;
+    std::atomic<bool> done(false);
+    std::atomic<bool> consistent(true);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&]() {
+            size_t page = 0;
+            while (!done.load()) {
+                int* value = map->get(base + page);
+                if (value && *value != static_cast<int>(page % 4)) {
+                    consistent.store(false);
+                }
+                page = (page + 7919) % PAGES;
+            }
+        });
+    }
+    std::vector<int> written(PAGES);
+    for (size_t i = 0; i < PAGES; i += Map::getLeafPages()) {
+        assert(map->ensure(base + i, Map::getLeafPages()));
+        for (size_t page = i; page < i + Map::getLeafPages(); ++page) {
+            written[page] = static_cast<int>(page % 4);
+            map->set(base + page, &written[page]);
+        }
+    }
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    assert(consistent.load() && *map->get(base + PAGES - 1) == static_cast<int>((PAGES - 1) % 4));
+    printTestResult("Lock-free readers during growth", true);
+}
+
+// Test 36: Contiguous runs from a bitmap pool
+void testBitmapPool() {
+    std::cout << YELLOW << "\n=== Test 36: Contiguous Runs ===" << RESET << std::endl;
+    
+    BitmapPool pool(40, 300);
+    size_t stride = pool.getBlockSize();
+    assert(stride == 48 && pool.getFreeBlocks() == 300);
+    
+    // Runs come back adjacent, first fit from the lowest address
+    char* a = static_cast<char*>(pool.allocateContiguous(3));
+    char* b = static_cast<char*>(pool.allocateContiguous(60));
+    char* c = static_cast<char*>(pool.allocate());
+    assert(a && b == a + 3 * stride && c == b + 60 * stride);
+    std::memset(b, 0xAB, 60 * stride);
+    assert(pool.getFreeBlocks() == 300 - 64);
+    printTestResult("Runs are adjacent blocks", true);
+    
+    // Run within a word, across a word boundary and across whole words
+    pool.deallocateContiguous(a, 3);
+    char* d = static_cast<char*>(pool.allocateContiguous(2));
+    assert(d == a);
+    char* e = static_cast<char*>(pool.allocateContiguous(5));
+    assert(e == c + stride);                    // Block 2 alone is too short
+    char* f = static_cast<char*>(pool.allocateContiguous(130));
+    assert(f == e + 5 * stride);                // Blocks 69 .. 198
+    assert(pool.allocateContiguous(102) == nullptr);
+    char* g = static_cast<char*>(pool.allocateContiguous(101));
+    assert(g == f + 130 * stride);              // The tail, ending at block 299
+    assert(pool.allocateContiguous(1) == a + 2 * stride);
+    assert(pool.getFreeBlocks() == 0 && pool.allocate() == nullptr);
+    assert(pool.allocateContiguous(0) == nullptr && pool.allocateContiguous(301) == nullptr);
+    printTestResult("Runs inside, across and spanning words", true);
+    
+    // Free every other block of f: plenty free, nothing adjacent
+    for (size_t i = 0; i < 130; i += 2) {
+        pool.deallocate(f + i * stride);
+    }
+    BitmapPoolStats stats = pool.getStats();
+    assert(stats.freeBlocks == 65 && stats.largestFreeRun == 1 && stats.freeRuns == 65);
+    assert(stats.fragmentation > 0.98 && pool.allocateContiguous(2) == nullptr);
+    for (size_t i = 1; i < 130; i += 2) {
+        pool.deallocate(f + i * stride);
+    }
+    stats = pool.getStats();
+    assert(stats.freeBlocks == 130 && stats.largestFreeRun == 130 && stats.freeRuns == 1);
+    assert(stats.fragmentation == 0.0);
+    printTestResult("Fragmentation stats", true);
+    
+    pool.deallocateContiguous(b, 60);
+    pool.deallocateContiguous(g, 101);
+    stats = pool.getStats();
+    assert(stats.freeRuns == 2 && stats.largestFreeRun == 231);
+    assert(pool.allocateContiguous(231) == f);
+    pool.deallocateContiguous(f, 231);
+    pool.deallocateContiguous(d, 2);
+    pool.deallocate(a + 2 * stride);
+    pool.deallocate(c);
+    pool.deallocateContiguous(e, 5);
+    stats = pool.getStats();
+    assert(stats.freeBlocks == 300 && stats.freeRuns == 1 && stats.largestFreeRun == 300);
+    printTestResult("Freed runs coalesce in the bitmap", true);
+    
+    #ifdef MEMPOOL_SAFE_MODE
+    bool caught = false;
+    try {
+        pool.deallocateContiguous(a, 2);
+    } catch (const std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+    printTestResult("Double free of a run detected", true);
+    #endif
+    
+    // Threads take runs of different lengths; a run overlapping another
+    // thread's would have its tag overwritten
+    BitmapPool shared(16, 4096, true);
+    std::atomic<bool> overlap(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            size_t n = size_t(1) << (t * 2);     // 1, 4, 16, 64
+            for (int round = 0; round < 500; ++round) {
+                char* run = static_cast<char*>(shared.allocateContiguous(n));
+                if (!run) {
+                    continue;
+                }
+                std::memset(run, t + 1, n * 16);
+                std::this_thread::yield();
+                for (size_t i = 0; i < n * 16; ++i) {
+                    if (run[i] != t + 1) {
+                        overlap.store(true);
+                    }
+                }
+                shared.deallocateContiguous(run, n);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(!overlap.load() && shared.getFreeBlocks() == 4096);
+    printTestResult("Thread-safe run allocation", true);
+    
+    // The mapping is reserved with MemoryPressure for the pool's lifetime
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t reservedBefore = MemoryPressure::getReservedBytes();
+    {
+        BitmapPool counted(64, 128);
+        assert(MemoryPressure::getReservedBytes() == reservedBefore + (64 * 128 + page - 1) / page * page);
+    }
+    assert(MemoryPressure::getReservedBytes() == reservedBefore);
+    printTestResult("Mapping reserved and released", true);
+}
+
+// Test 37: Streamed free-list links on ranges of any alignment
+void testBlockLinker() {
+    std::cout << YELLOW << "\n=== Test 37: Block Linker ===" << RESET << std::endl;
+    
+    // 32 MB and up is linked with streaming stores, whose width must
+    // follow the alignment of the range rather than its size
+    const size_t BLOCK_SIZE = 64;
+    const size_t COUNT = 32 * 1024 * 1024 / BLOCK_SIZE;
+    std::vector<char> buffer(BLOCK_SIZE * COUNT + 128);
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(buffer.data()) + 63) & ~uintptr_t(63));
+    for (size_t offset : { 0, 8, 16, 32 }) {
+        char* start = aligned + offset;
+        int tail = 0;
+        linkBlocks(start, BLOCK_SIZE, COUNT, &tail);
+        bool linked = true;
+        for (size_t i = 0; i + 1 < COUNT; ++i) {
+            linked &= *reinterpret_cast<char**>(start + i * BLOCK_SIZE) == start + (i + 1) * BLOCK_SIZE;
+        }
+        assert(linked && *reinterpret_cast<void**>(start + (COUNT - 1) * BLOCK_SIZE) == &tail);
+    }
+    printTestResult("Large ranges linked at 0, 8, 16 and 32 bytes past a line", true);
+}
+
 int main() {
     std::cout << GREEN << "╔════════════════════════════════════════╗" << RESET << std::endl;
     std::cout << GREEN << "║  Memory Pool Unit Tests               ║" << RESET << std::endl;
@@ -309,6 +2325,32 @@ int main() {
         testReset();
         testStressTest();
         testDifferentBlockSizes();
+        testQuarantine();
+        testLeakTracking();
+        testHeapProfiler();
+        testSnapshot();
+        testTrim();
+        testRegistry();
+        testResidentPool();
+        testZeroedAllocation();
+        testParallelInit();
+        testBasicPool();
+        testSmallObjectAllocator();
+        testBlockCaches();
+        testEpochReclaimer();
+        testLockFreePool();
+        testFlatCombining();
+        testDelegatedAllocator();
+        testAllocateWait();
+        testMemoryPressure();
+        testTenantQuotas();
+        testPriorityReserve();
+        testAsyncAllocator();
+        testReservedGrowth();
+        testAlignedChunkPool();
+        testPageMap();
+        testBitmapPool();
+        testBlockLinker();
         
         std::cout << GREEN << "\n╔════════════════════════════════════════╗" << RESET << std::endl;
         std::cout << GREEN << "║  All tests passed! ✓                   ║" << RESET << std::endl;